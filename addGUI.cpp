@@ -1,10 +1,16 @@
 #include <iostream>
 #include <string>
 #include <cstdlib>
-#include <cmath>
-#include <ctime>
+#include <vector>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include "board.h"
+#include "boardpool.h"
+#include "guiView.h"
+#include "snapshot.h"
+#include "movelog.h"
+#include "history.h"
+#include "stats.h"
 using namespace std;
 
 #define bold "\033[1m"
@@ -18,441 +24,60 @@ using namespace std;
 #define colorSeven "\033[30m"      
 #define colorEight "\033[90m"      
 
-class Cell;
-class Board;
+// pixels an arrow key scrolls, and the zoom step of one wheel notch or +/- press
+const float PAN_STEP = 53;
+const float ZOOM_STEP = 1.25f;
 
-void renderText(SDL_Renderer* renderer, TTF_Font* font, string& text, SDL_Color color, int x, int y){
-    SDL_Surface *textSurface = TTF_RenderText_Blended(font, text.c_str(), color);
-    SDL_Texture *textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-    SDL_Rect renderRect = {x,y,textSurface->w, textSurface->h};
-    SDL_FreeSurface(textSurface);
-    SDL_RenderCopy(renderer,textTexture,NULL,&renderRect);
-    SDL_DestroyTexture(textTexture);
-}
-
-class Cell{
-    public:
-        Cell();
-        char getValue() const;
-        void setValue(char value);
-        bool getFlag() const;
-        void setFlag(bool value);
-        char getDisplayValue();
-        void setDisplayValue(char value);
-        void setBomb(bool value);
-        void setBoard(Board* board);
-        bool isBomb() const;
-        bool isOpened() const;
-        void openCell();
-    private: 
-        Board* m_board;
-        char m_value;
-        char m_display_value;
-        bool m_opened;
-        bool m_flagged;
-        bool m_bomb;
-};
-
-class Board{
-    public:
-        Board(int rows, int cols, int bombs);
-        ~Board();
-        void calculateValue(int row, int col);
-        void bombOpened();
-        void displayBoard(SDL_Renderer* rend, TTF_Font* font);
-        void flagCell(int row, int col);
-        void processMove(int row, int col);
-        bool checkMove(int row, int col);
-        void handleFirstClick(int row, int col);
-        void floodFill(int row, int col);
-        bool stillPlaying();
-        bool getWin();
-        bool isNeighbor(int r1, int c1, int r2, int c2);
-        void printValue(char value);
-    private: 
-        Cell** m_grid;
-        int m_bombs;
-        int m_rows;
-        int m_cols;
-        int bombsFlagged;
-        bool activeBoard;
-        bool won;
-};
-
-Cell::Cell()
-{
-    m_display_value = 'U';
-    m_bomb = false;
-    if(m_bomb) m_value = 'X';
-    else m_value = ' ';
-    m_opened = false;
-    m_flagged = false;
-    m_board = nullptr;
-}
-
-char Cell::getValue() const
-{
-    return m_value;
-}
-
-void Cell::setValue(char value)
-{
-    m_value = value;
-}
-
-bool Cell::getFlag() const
-{
-    return m_flagged;
-}
-
-void Cell::setFlag(bool value)
-{
-    m_flagged = value;
-}
-
-bool Cell::isBomb() const
-{
-    return m_bomb;
-}
-
-void Cell::setBoard(Board *board)
-{
-    m_board = board;
-}
-
-bool Cell::isOpened() const
-{
-    return m_opened;
-}
-
-char Cell::getDisplayValue()
-{
-    return m_display_value;
-}
-
-void Cell::setDisplayValue(char value)
-{
-    m_display_value = value;
-}
-
-void Cell::setBomb(bool value)
-{
-    m_bomb = value;
-}
-
-void Cell::openCell()
-{
-    if(m_flagged) return;
-    m_opened = true;
-    if(isBomb()){
-        m_board->bombOpened();
-    }
-    else{
-        setDisplayValue(m_value);
-    }
-}
-
-Board::Board(int rows, int cols, int bombs)
-{
-    activeBoard = true;
-    won = false;
-    m_bombs = bombs;
-    m_rows = rows;
-    m_cols = cols;
-    m_grid = new Cell*[rows];
-    for(int i = 0; i < rows; i++){
-        m_grid[i] = new Cell[cols];
-    }
-    bombsFlagged = 0;
-}
-
-Board::~Board()
-{
-    for(int i = 0; i < m_rows; i++){
-        delete[] m_grid[i];
-    }
-    delete[] m_grid;
-}
-
-void Board::calculateValue(int row, int col)
-{
-    int valueCounter = 0;
-    if(col + 1 < m_cols && m_grid[row][col+1].isBomb()) valueCounter++;
-    if(row + 1 < m_rows && m_grid[row+1][col].isBomb()) valueCounter++;
-    if(row + 1 < m_rows && col + 1 < m_cols && m_grid[row+1][col+1].isBomb()) valueCounter++;
-    if(row > 0 && m_grid[row-1][col].isBomb()) valueCounter++;
-    if(col > 0 && m_grid[row][col-1].isBomb()) valueCounter++;
-    if(row > 0 && col > 0 && m_grid[row-1][col-1].isBomb()) valueCounter++;
-    if(row > 0 && col + 1 < m_cols && m_grid[row-1][col+1].isBomb()) valueCounter++;
-    if(col > 0 && row + 1 < m_rows && m_grid[row+1][col-1].isBomb()) valueCounter++;
-    if (m_grid[row][col].isBomb()) m_grid[row][col].setValue('X');
-    else if(valueCounter > 0) m_grid[row][col].setValue(valueCounter + '0');
-    else m_grid[row][col].setValue(' ');
-}
-
-void Board::bombOpened()
-{
-    activeBoard = false;
-    won = false;
-}
-
-
-void Board::printValue(char value){
-    if(value == 'U') cout << colorEight << value << reset << "  ";
-    else if(value == 'X') cout << colorFive << value << reset << "  ";
-    else if(value == 'F') cout << colorThree << value << reset <<  "  ";
-    else if(value == '1') cout << colorOne << value << reset << "  "; 
-    else if(value == '2') cout << colorTwo << value << reset << "  ";
-    else if(value == '3') cout << colorThree << value << reset << "  ";    
-    else if(value == '4') cout << colorFour << value << reset << "  ";
-    else if(value == '5') cout << colorFive << value << reset << "  ";
-    else if(value == '6') cout << colorSix << value << reset << "  ";
-    else if(value == '7') cout << colorSeven << value << reset << "  ";
-    else if(value == '8') cout << colorEight << value << reset << "  ";
-    else cout << value << "  ";
-}
-
-void Board::flagCell(int row, int col)
-{
-    if(!m_grid[row][col].isOpened()) {
-        if(m_grid[row][col].getFlag()){
-            m_grid[row][col].setFlag(false);
-            bombsFlagged--;
-        }
-        else{
-            m_grid[row][col].setFlag(true);
-            bombsFlagged++;
-        }
-    }
-}
-
-void Board::processMove(int row, int col)
-{
-    if(checkMove(row, col)){
-        if(m_grid[row][col].getValue() == ' ') floodFill(row, col);
-        else m_grid[row][col].openCell();
-    }
-}
-
-bool Board::checkMove(int row, int col){
-    return (row >= 0 && row < m_rows && col >= 0 && col < m_cols && !m_grid[row][col].isOpened());
-}
-
-void Board::handleFirstClick(int row, int col){
-    int r = 0;
-    int c = 0;
-    srand(time(0));
-    bool** bombMatrix;
-    bombMatrix = new bool*[m_rows];
-    for(int i = 0; i < m_rows; i++){
-        bombMatrix[i] = new bool[m_cols]();
-    }
-    for(int i = 0; i < m_bombs; i++){
-        r = rand() % m_rows;
-        c = rand() % m_cols;
-        while(isNeighbor(r,c,row,col) || bombMatrix[r][c]){
-            r = rand() % m_rows;
-            c = rand() % m_cols;
-        }
-        bombMatrix[r][c] = true;
-    }
-
-    for(int i = 0; i < m_rows; i++){
-        for(int j = 0; j < m_cols; j++){
-            m_grid[i][j].setBomb(bombMatrix[i][j]);
-            m_grid[i][j].setBoard(this);
+// minesweeperGUI [rows cols bombs | --load file] [--record log]: any size is playable. The wheel
+// or +/- zooms, dragging with the middle button or the arrow keys scroll. Ctrl+S saves a
+// snapshot of the game to the loaded file, or to minesweeper.snap, and --load picks it up
+// again. Ctrl+Z and Ctrl+Y undo and redo moves. --record writes every move to a move log for
+// the replay tool. Built with -DMINESWEEPER_STATS, F12 writes the hot-path stats (see stats.h),
+// as does quitting.
+int main( int argc, char *argv[] ){
+   int rows = 10, cols = 10, bombs = 10;
+   Snapshot snapshot;
+   string snapshotPath = "minesweeper.snap";
+   MoveLogWriter log;
+   bool loading = false, usage = false;
+   vector<int> sizes;
+   for(int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if(arg == "--load" && i + 1 < argc){
+            snapshotPath = argv[++i];
+            loading = true;
         }
-    }
-    for(int i = 0; i < m_rows; i++){
-        for(int j = 0; j < m_cols; j++){
-            calculateValue(i, j);
+        else if(arg == "--record" && i + 1 < argc){
+            if(!log.open(argv[++i])){
+                cerr << log.getError() << endl;
+                return EXIT_FAILURE;
+            }
         }
+        else sizes.push_back(atoi(argv[i]));
     }
-    floodFill(row, col);
-
-    for (int i = 0; i < m_rows; i++) {
-        delete[] bombMatrix[i];
+   if(sizes.size() == 3){
+        rows = sizes[0];
+        cols = sizes[1];
+        bombs = sizes[2];
     }
-    delete[] bombMatrix;
-}
-
-void Board::floodFill(int row, int col)
-{
-    if(row < 0 || col < 0 || row >= m_rows || col >= m_cols || m_grid[row][col].isOpened() ||  m_grid[row][col].getFlag()) return;
-    m_grid[row][col].openCell();
-    if(m_grid[row][col].getValue() != ' ') return;
-    floodFill(row+1,col);
-    floodFill(row,col+1);
-    floodFill(row+1,col+1);
-    floodFill(row-1,col-1);   
-    floodFill(row,col-1); 
-    floodFill(row-1,col); 
-    floodFill(row-1,col+1);
-    floodFill(row+1,col-1); 
-}
-
-void drawBoxWithBorder(SDL_Renderer* renderer, SDL_Rect rect, SDL_Color fillColor, SDL_Color borderColor) {
-    SDL_SetRenderDrawColor(renderer, fillColor.r, fillColor.g, fillColor.b, fillColor.a);
-    SDL_RenderFillRect(renderer, &rect);
-
-    SDL_SetRenderDrawColor(renderer, borderColor.r, borderColor.g, borderColor.b, borderColor.a);
-    SDL_RenderDrawRect(renderer, &rect);
-}
-
-void drawBackground(SDL_Renderer* renderer){
-   SDL_RenderClear(renderer);
-   SDL_Rect outerBox;
-   outerBox.x = 50;
-   outerBox.y = 50;
-   outerBox.w = 570;
-   outerBox.h = 650;
-   SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-   SDL_RenderDrawRect(renderer, &outerBox);
-   
-   SDL_Rect innerBox;
-   innerBox.x = 70;
-   innerBox.y = 70;
-   innerBox.w = 530;
-   innerBox.h = 60;
-   SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-   SDL_RenderDrawRect(renderer, &innerBox);
-
-    SDL_Rect gameplayBox;
-    gameplayBox.x = 70;
-    gameplayBox.y = 150;
-    gameplayBox.w = 530;
-    gameplayBox.h = 530;
-    SDL_RenderDrawRect(renderer, &gameplayBox);
-
-    for(int i = 0; i < 10; i++){
-        for(int j = 0; j < 10; j++){
-            SDL_Rect box;
-            box.x = 70 + i*53;
-            box.y = 150 + j*53;
-            box.w = 53;
-            box.h = 53;
-            SDL_Color f = {0, 0, 255, 0};   
-            SDL_Color b = {0, 255, 0, 0};  
-            drawBoxWithBorder(renderer, box, f, b);
+   else if(!sizes.empty()) usage = true;
+   if(loading){
+        // a log replays from a fresh board, so a resumed game cannot be recorded
+        if(log.isOpen() || !sizes.empty()) usage = true;
+        else if(!snapshot.load(snapshotPath)){
+            cerr << snapshot.getError() << endl;
+            return EXIT_FAILURE;
         }
-    }
-
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    SDL_Rect smileBox;
-    smileBox.x = 315;
-    smileBox.y = 80;
-    smileBox.w = 40;
-    smileBox.h = 40;
-    SDL_RenderDrawRect(renderer, &smileBox);
-
-    SDL_Rect eyeBox;
-    eyeBox.x = 323;
-    eyeBox.y = 88;
-    eyeBox.w = 8;
-    eyeBox.h = 8;
-    SDL_RenderFillRect(renderer, &eyeBox);
-
-    SDL_Rect eyeBox2;
-    eyeBox2.x = 338;
-    eyeBox2.y = 88;
-    eyeBox2.w = 8;
-    eyeBox2.h = 8;
-    SDL_RenderFillRect(renderer, &eyeBox2);
-
-    SDL_RenderDrawLine(renderer, 323, 105, 335, 115);
-    SDL_RenderDrawLine(renderer, 335, 115, 347, 105);
-
-    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-    SDL_Rect flagBox;
-    flagBox.x = 100;
-    flagBox.y = 80;
-    flagBox.w = 120;
-    flagBox.h = 40;
-    SDL_RenderDrawRect(renderer, &flagBox);
-
-    SDL_Rect timerBox;
-    timerBox.x = 450;
-    timerBox.y = 80;
-    timerBox.w = 120;
-    timerBox.h = 40;
-    SDL_RenderDrawRect(renderer, &timerBox);
-
-
-
-}
-
-bool Board::stillPlaying()
-{
-    if(!activeBoard){
-        return false;
-    }
-    for(int i = 0; i < m_rows; i++){
-        for(int j = 0; j < m_cols; j++){
-            if(!m_grid[i][j].isOpened() && !m_grid[i][j].isBomb()){
-                return true;
-            }
+        else{
+            rows = snapshot.getBoard()->getRows();
+            cols = snapshot.getBoard()->getCols();
+            bombs = snapshot.getBoard()->getBombs();
         }
     }
-    won = true;
-    return false;
-}
-
-void Board::displayBoard(SDL_Renderer* rend, TTF_Font* font){
-    SDL_Color b = {255,255,255,0};
-    SDL_Color f = {0,0,0,0};
-    SDL_Color color = {255,255,255,0};
-    SDL_RenderClear(rend);
-    drawBackground(rend);
-    string text = to_string(bombsFlagged);
-    int buffer = 0;
-    if(bombsFlagged > 9) buffer = 8;
-    renderText(rend, font, text, color, 155 - buffer, 88);
-    color = {255,255,255,255};
-    for(int i = 0; i < 10; i++){
-        for(int j = 0; j < 10; j++){
-            SDL_Rect box;
-            box.x = 70 + j*53;
-            box.y = 150 + i*53;
-            box.w = 53;
-            box.h = 53;
-            if(m_grid[i][j].getFlag()){
-                f = {255, 255, 255, 0}; 
-            }
-            else if(m_grid[i][j].isOpened()){
-                f = {255, 0, 255, 0};
-            }
-            else{
-                f = {0, 0, 255, 0};   
-            }
-            if(m_grid[i][j].isOpened())
-                text = string(1,m_grid[i][j].getValue());
-            else text = " ";
-            drawBoxWithBorder(rend, box, f, b);
-            renderText(rend, font, text, color, 77 + j*53, 157 + i*53);
-        }
+   if(usage || rows < 1 || cols < 1 || bombs < 0){
+        cerr << "usage: minesweeperGUI [rows cols bombs | --load file] [--record log]" << endl;
+        return EXIT_FAILURE;
     }
-}
-
-bool Board::getWin()
-{
-    return won;
-}
-
-bool Board::isNeighbor(int r1, int c1, int r2, int c2)
-{
-    return (abs(r1 - r2) <= 1) && (abs(c1 - c2) <= 1);
-}
-
-bool translateMove(int x, int y, int &r, int &c){
-    r = (y - 150) / 53;
-    c = (x - 70)/53;
-    if(r > -1 && r < 10 && c > -1 && c < 10) return true;
-    else return false;
-}
-
-
-
-int main( int argc, char *argv[] ){
    SDL_Init(SDL_INIT_EVERYTHING);
    if (TTF_Init() < 0) {
         cerr << "TTF initialization failed: " << TTF_GetError() << endl;
@@ -462,57 +87,189 @@ int main( int argc, char *argv[] ){
    SDL_Window *window = SDL_CreateWindow("Minesweeper", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 670, 750, SDL_WINDOW_ALLOW_HIGHDPI);
    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
    TTF_Font* font = TTF_OpenFont("src/include/SDL2/Roboto-Medium.ttf", 20);
-   drawBackground(renderer);
-   Board* board = new Board(10, 10, 10);
+   GlyphAtlas atlas;
+   if(!font || !atlas.build(renderer, font)){
+        cerr << "Font loading failed: " << TTF_GetError() << endl;
+        return EXIT_FAILURE;
+    }
+   // frees the board on the way out, unless it is the snapshot's
+   BoardPool boards;
+   Board* board = snapshot.getBoard() ? snapshot.getBoard() : boards.acquire(rows, cols, bombs);
+    Camera camera({70, 150, 530, 530}, rows, cols);
+    // cells opened or flagged since the last frame
+    vector<int> changed;
+    board->trackChanges(&changed);
+
+    // The scene lives in a target texture that is patched in place, since the window's back
+    // buffer is not kept between presents. A frame copies it to the window.
+    SDL_Texture* canvas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, 670, 750);
+    SDL_SetRenderTarget(renderer, canvas);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    displayBoard(renderer, atlas, *board, camera);
+    drawTimer(renderer, atlas, 0);
+    SDL_SetRenderTarget(renderer, NULL);
+    bool present = true;
+
     SDL_Event windowEvent;
-    bool firstClick = true;
+    History history;
+    board->trackHistory(&history);
+    bool firstClick = !board->getMinesPlaced();
+    log.beginGame();
     bool running = true;
     int r,c;
+    bool viewMoved = false;
+    int shownFlags = 0;
+    Uint32 shownSeconds = 0;
     Uint32 startTime = SDL_GetTicks();
-    while(running && board->stillPlaying()){
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255); 
+    while(running){
+        if(present){
+            STAT_TIME(STAT_FRAME_PRESENT);
+            SDL_RenderCopy(renderer, canvas, NULL, NULL);
+            SDL_RenderPresent(renderer);
+            present = false;
+        }
 
-        while (SDL_PollEvent(&windowEvent)) {
-            switch (windowEvent.type) {
-                case SDL_MOUSEBUTTONDOWN: {
-                    if(translateMove(windowEvent.button.x, windowEvent.button.y, r, c)){
-                        cout << "r: " << r << " c: " << c << endl;
-                        if (windowEvent.button.button == SDL_BUTTON_LEFT) {
-                            if(firstClick){
-                                board->handleFirstClick(r,c);
-                                firstClick = false;
+        // sleep until something happens or the timer shows the next second
+        Uint32 nextTick = startTime + (shownSeconds + 1) * 1000;
+        Uint32 now = SDL_GetTicks();
+        int timeout = nextTick > now ? nextTick - now : 0;
+        if(SDL_WaitEventTimeout(&windowEvent, timeout)){
+            STAT_TIME(STAT_FRAME_EVENTS);
+            do{
+                switch (windowEvent.type) {
+                    case SDL_MOUSEBUTTONDOWN: {
+                        if(camera.cellAt(windowEvent.button.x, windowEvent.button.y, r, c)){
+                            if (windowEvent.button.button == SDL_BUTTON_LEFT) {
+                                if(firstClick){
+                                    board->handleFirstClick(r,c);
+                                    log.record(*board, ACTION_FIRST_CLICK, r, c);
+                                    firstClick = false;
+                                }
+                                else{
+                                    board->processMove(r,c);
+                                    log.record(*board, ACTION_OPEN, r, c);
+                                }
+                            } else if (windowEvent.button.button == SDL_BUTTON_RIGHT) {
+                                board->flagCell(r,c);
+                                log.record(*board, ACTION_FLAG, r, c);
                             }
-                            board->processMove(r,c);
-                        } else if (windowEvent.button.button == SDL_BUTTON_RIGHT) {
-                            board->flagCell(r,c);
                         }
+                        break;
+                    }
+                    case SDL_MOUSEMOTION: {
+                        if(windowEvent.motion.state & SDL_BUTTON_MMASK){
+                            camera.pan(-windowEvent.motion.xrel, -windowEvent.motion.yrel);
+                            viewMoved = true;
+                        }
+                        break;
+                    }
+                    case SDL_MOUSEWHEEL: {
+                        int x, y;
+                        SDL_GetMouseState(&x, &y);
+                        camera.zoom(windowEvent.wheel.y > 0 ? ZOOM_STEP : 1 / ZOOM_STEP, x, y);
+                        viewMoved = true;
+                        break;
+                    }
+                    case SDL_KEYDOWN: {
+                        const SDL_Rect& view = camera.getViewport();
+                        int sym = windowEvent.key.keysym.sym;
+                        if(sym == SDLK_LEFT) camera.pan(-PAN_STEP, 0);
+                        else if(sym == SDLK_RIGHT) camera.pan(PAN_STEP, 0);
+                        else if(sym == SDLK_UP) camera.pan(0, -PAN_STEP);
+                        else if(sym == SDLK_DOWN) camera.pan(0, PAN_STEP);
+                        else if(sym == SDLK_EQUALS || sym == SDLK_PLUS) camera.zoom(ZOOM_STEP, view.x + view.w / 2, view.y + view.h / 2);
+                        else if(sym == SDLK_MINUS) camera.zoom(1 / ZOOM_STEP, view.x + view.w / 2, view.y + view.h / 2);
+                        else if((sym == SDLK_z || sym == SDLK_y) && (windowEvent.key.keysym.mod & KMOD_CTRL)){
+                            bool undo = sym == SDLK_z;
+                            if(undo ? board->undo() : board->redo()){
+                                log.record(*board, undo ? ACTION_UNDO : ACTION_REDO, 0, 0);
+                                // undoing the first click lifts the mines again
+                                firstClick = !board->getMinesPlaced();
+                            }
+                            break;
+                        }
+                        else if(sym == SDLK_s && (windowEvent.key.keysym.mod & KMOD_CTRL)){
+                            if(snapshot.save(*board, snapshotPath)) cout << "Saved to " << snapshotPath << endl;
+                            else cerr << snapshot.getError() << endl;
+                            break;
+                        }
+                        else if(sym == SDLK_F12 && STATS_ENABLED){
+                            if(writeStats(statsPath())) cout << "Stats written to " << statsPath() << endl;
+                            else cerr << "cannot write " << statsPath() << endl;
+                            break;
+                        }
+                        else break;
+                        viewMoved = true;
+                        break;
+                    }
+                    case SDL_WINDOWEVENT: {
+                        if(windowEvent.window.event == SDL_WINDOWEVENT_EXPOSED) present = true;
+                        break;
+                    }
+                    case SDL_QUIT: {
+                        running = false;
+                        break;
                     }
-                    break;
-                }
-                case SDL_QUIT: {
-                    running = false;
-                    break;
                 }
+            }while(SDL_PollEvent(&windowEvent));
+            log.flush();
+        }
+
+        SDL_SetRenderTarget(renderer, canvas);
+        // a moved view, or more changes than there are cells on screen, redraws the whole view
+        int firstRow, lastRow, firstCol, lastCol;
+        camera.visibleCells(firstRow, lastRow, firstCol, lastCol);
+        if(viewMoved || changed.size() > size_t(lastRow - firstRow) * (lastCol - firstCol)){
+            STAT_TIME(STAT_FRAME_BOARD);
+            drawBoardView(renderer, atlas, *board, camera);
+            present = true;
+        }
+        else if(!changed.empty()){
+            STAT_TIME(STAT_FRAME_BOARD);
+            for(int cell : changed){
+                drawCell(renderer, atlas, *board, camera, cell / cols, cell % cols);
             }
+            present = true;
+        }
+        changed.clear();
+        viewMoved = false;
+        if(board->getFlagCount() != shownFlags){
+            STAT_TIME(STAT_FRAME_HUD);
+            shownFlags = board->getFlagCount();
+            drawFlagCount(renderer, atlas, *board);
+            present = true;
+        }
+        Uint32 seconds = (SDL_GetTicks() - startTime) / 1000;
+        if(seconds != shownSeconds){
+            STAT_TIME(STAT_FRAME_HUD);
+            shownSeconds = seconds;
+            drawTimer(renderer, atlas, seconds);
+            present = true;
         }
+        SDL_SetRenderTarget(renderer, NULL);
+
         if(!board->stillPlaying()){
             if(board->getWin()) cout << "You won";
             else cout << "You lost";
             running = false;
+            // the last move is only on the canvas so far; show it until the window is closed,
+            // a key is pressed or the board is clicked
+            SDL_RenderCopy(renderer, canvas, NULL, NULL);
+            SDL_RenderPresent(renderer);
+            while(SDL_WaitEvent(&windowEvent) && windowEvent.type != SDL_QUIT && windowEvent.type != SDL_KEYDOWN && windowEvent.type != SDL_MOUSEBUTTONDOWN){
+                if(windowEvent.type == SDL_WINDOWEVENT && windowEvent.window.event == SDL_WINDOWEVENT_EXPOSED){
+                    SDL_RenderCopy(renderer, canvas, NULL, NULL);
+                    SDL_RenderPresent(renderer);
+                }
+            }
         }
-
-        Uint32 elapsedTime = SDL_GetTicks() - startTime;
-        string timerTxt = to_string(elapsedTime/1000);
-    
-
-
-        board->displayBoard(renderer, font);
-        SDL_Color timeColor = {255,255,255,255};
-        renderText(renderer,font, timerTxt,timeColor, 505,88);
-        SDL_RenderPresent(renderer);
     }
 
-
+    if(STATS_ENABLED && !writeStats(statsPath())) cerr << "cannot write " << statsPath() << endl;
+    board->trackChanges(nullptr);
+    board->trackHistory(nullptr);
+    SDL_DestroyTexture(canvas);
+    atlas.clear();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow( window );
     TTF_CloseFont(font);
@@ -520,3 +277,4 @@ int main( int argc, char *argv[] ){
     SDL_Quit( );
     return EXIT_SUCCESS;
 }
+
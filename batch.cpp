@@ -0,0 +1,308 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "board.h"
+#include "presetboard.h"
+#include "solver.h"
+#include "probability.h"
+#include "stats.h"
+using namespace std;
+
+// Headless batch runner: plays every seed in [seedBegin, seedEnd) with the chosen policy on all
+// cores and prints aggregated statistics.
+//
+//   batch rows cols mines seedBegin seedEnd random|solver|best [threads]
+//
+// "solver" guesses at random when deduction is stuck; "best" asks the probability engine for
+// the safest cell instead, at the cost of some allocation inside the engine.
+//
+// Seeds are handed out in blocks through per-worker queues; a worker that runs dry steals
+// blocks from the back of another worker's queue. Each worker owns one Board and one Random
+// and resets them between games, so the game loop itself never allocates. Built with
+// -DMINESWEEPER_STATS, each worker's hot-path stats (see stats.h) are written at the end.
+
+const int SEED_BLOCK = 256;
+const int OPENING_BUCKETS = 32;
+
+enum Policy{
+    POLICY_RANDOM,
+    POLICY_SOLVER,
+    POLICY_BEST
+};
+
+struct BatchStats{
+    uint64_t games = 0;
+    uint64_t wins = 0;
+    uint64_t moves = 0;
+    uint64_t openingCells = 0;
+    uint64_t openedCells = 0;
+    uint64_t openingSizes[OPENING_BUCKETS] = {};
+
+    void add(const BatchStats& other);
+};
+
+class SeedQueue{
+    public:
+        void push(uint64_t begin, uint64_t end);
+        bool pop(uint64_t& begin, uint64_t& end);
+        bool steal(uint64_t& begin, uint64_t& end);
+    private:
+        mutex m_lock;
+        deque<pair<uint64_t, uint64_t>> m_blocks;
+};
+
+class Worker{
+    public:
+        Worker(int rows, int cols, int mines, Policy policy);
+        ~Worker();
+        void run(vector<SeedQueue>& queues, int self);
+        const BatchStats& getStats() const;
+    private:
+        Worker(const Worker&);
+        Worker& operator=(const Worker&);
+        void playGame(uint64_t seed);
+        bool randomMove(Random& rng);
+        bool solverMove(Random& rng);
+        bool safestMove(Random& rng);
+        // a PresetBoard on the standard level sizes
+        Board* m_board;
+        Solver m_solver;
+        ProbabilityEngine m_engine;
+        vector<double> m_probabilities;
+        vector<int> m_safe;
+        vector<int> m_mines;
+        Policy m_policy;
+        BatchStats m_stats;
+};
+
+void BatchStats::add(const BatchStats& other)
+{
+    games += other.games;
+    wins += other.wins;
+    moves += other.moves;
+    openingCells += other.openingCells;
+    openedCells += other.openedCells;
+    for(int i = 0; i < OPENING_BUCKETS; i++){
+        openingSizes[i] += other.openingSizes[i];
+    }
+}
+
+void SeedQueue::push(uint64_t begin, uint64_t end)
+{
+    lock_guard<mutex> guard(m_lock);
+    m_blocks.push_back(make_pair(begin, end));
+}
+
+bool SeedQueue::pop(uint64_t& begin, uint64_t& end)
+{
+    lock_guard<mutex> guard(m_lock);
+    if(m_blocks.empty()) return false;
+    begin = m_blocks.front().first;
+    end = m_blocks.front().second;
+    m_blocks.pop_front();
+    return true;
+}
+
+bool SeedQueue::steal(uint64_t& begin, uint64_t& end)
+{
+    lock_guard<mutex> guard(m_lock);
+    if(m_blocks.empty()) return false;
+    begin = m_blocks.back().first;
+    end = m_blocks.back().second;
+    m_blocks.pop_back();
+    return true;
+}
+
+Worker::Worker(int rows, int cols, int mines, Policy policy)
+{
+    m_board = newBoard(rows, cols, mines);
+    m_policy = policy;
+}
+
+Worker::~Worker()
+{
+    delete m_board;
+}
+
+const BatchStats& Worker::getStats() const
+{
+    return m_stats;
+}
+
+void Worker::run(vector<SeedQueue>& queues, int self)
+{
+    int workers = queues.size();
+    uint64_t begin, end;
+    while(true){
+        bool found = queues[self].pop(begin, end);
+        for(int i = 1; !found && i < workers; i++){
+            found = queues[(self + i) % workers].steal(begin, end);
+        }
+        if(!found) return;
+        for(uint64_t seed = begin; seed < end; seed++){
+            playGame(seed);
+        }
+    }
+}
+
+void Worker::playGame(uint64_t seed)
+{
+    int rows = m_board->getRows();
+    int cols = m_board->getCols();
+    Random rng(seed ^ 0x5DEECE66DULL);
+    m_board->reset();
+    m_board->setSeed(seed);
+    if(m_policy == POLICY_RANDOM) m_board->handleFirstClick(rng.below(rows), rng.below(cols));
+    else m_board->handleFirstClick(rows / 2, cols / 2);
+
+    int safeCells = rows * cols - m_board->getBombs();
+    int opening = safeCells - m_board->getUnopenedSafe();
+    int bucket = 0;
+    while((2 << bucket) <= opening && bucket + 1 < OPENING_BUCKETS) bucket++;
+    m_stats.openingSizes[bucket]++;
+    m_stats.openingCells += opening;
+    m_stats.moves++;
+
+    while(m_board->stillPlaying()){
+        bool moved = m_policy == POLICY_RANDOM ? randomMove(rng) : solverMove(rng);
+        if(!moved) break;
+        m_stats.moves++;
+    }
+    m_stats.games++;
+    if(m_board->getWin()) m_stats.wins++;
+    m_stats.openedCells += safeCells - m_board->getUnopenedSafe();
+}
+
+// Opens a uniformly chosen closed cell. Falls back to a scan from a random start once the
+// board is so far along that sampling keeps hitting open cells.
+bool Worker::randomMove(Random& rng)
+{
+    int rows = m_board->getRows();
+    int cols = m_board->getCols();
+    int cells = rows * cols;
+    for(int attempt = 0; attempt < 64; attempt++){
+        int i = rng.below(cells);
+        if(!m_board->getCell(i / cols, i % cols).isOpened() && !m_board->getCell(i / cols, i % cols).getFlag()){
+            m_board->processMove(i / cols, i % cols);
+            return true;
+        }
+    }
+    int start = rng.below(cells);
+    for(int n = 0; n < cells; n++){
+        int i = (start + n) % cells;
+        if(!m_board->getCell(i / cols, i % cols).isOpened() && !m_board->getCell(i / cols, i % cols).getFlag()){
+            m_board->processMove(i / cols, i % cols);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Applies everything the solver can prove this round, or guesses at random when it is stuck.
+bool Worker::solverMove(Random& rng)
+{
+    int cols = m_board->getCols();
+    m_safe.clear();
+    m_mines.clear();
+    if(!m_solver.solve(*m_board, m_safe, m_mines)){
+        return m_policy == POLICY_BEST ? safestMove(rng) : randomMove(rng);
+    }
+    for(int cell : m_mines){
+        m_board->flagCell(cell / cols, cell % cols);
+    }
+    for(int cell : m_safe){
+        if(!m_board->stillPlaying()) break;
+        m_board->processMove(cell / cols, cell % cols);
+    }
+    return true;
+}
+
+// Opens the closed cell least likely to hold a bomb.
+bool Worker::safestMove(Random& rng)
+{
+    if(!m_engine.compute(*m_board, m_probabilities)) return randomMove(rng);
+    int cols = m_board->getCols();
+    int best = -1;
+    for(int cell = 0; cell < (int)m_probabilities.size(); cell++){
+        const Cell& c = m_board->getCell(cell / cols, cell % cols);
+        if(c.isOpened() || c.getFlag()) continue;
+        if(best < 0 || m_probabilities[cell] < m_probabilities[best]) best = cell;
+    }
+    if(best < 0) return false;
+    m_board->processMove(best / cols, best % cols);
+    return true;
+}
+
+int main(int argc, char* argv[]){
+    if(argc < 7){
+        cerr << "usage: " << argv[0] << " rows cols mines seedBegin seedEnd random|solver|best [threads]" << endl;
+        return EXIT_FAILURE;
+    }
+    int rows = atoi(argv[1]);
+    int cols = atoi(argv[2]);
+    int mines = atoi(argv[3]);
+    uint64_t seedBegin = strtoull(argv[4], nullptr, 10);
+    uint64_t seedEnd = strtoull(argv[5], nullptr, 10);
+    Policy policy;
+    if(strcmp(argv[6], "random") == 0) policy = POLICY_RANDOM;
+    else if(strcmp(argv[6], "solver") == 0) policy = POLICY_SOLVER;
+    else if(strcmp(argv[6], "best") == 0) policy = POLICY_BEST;
+    else{
+        cerr << "unknown policy " << argv[6] << endl;
+        return EXIT_FAILURE;
+    }
+    int threads = argc > 7 ? atoi(argv[7]) : thread::hardware_concurrency();
+    if(threads < 1) threads = 1;
+    if(rows < 1 || cols < 1 || mines < 0 || seedEnd < seedBegin){
+        cerr << "invalid board size, mine count or seed range" << endl;
+        return EXIT_FAILURE;
+    }
+
+    vector<SeedQueue> queues(threads);
+    int next = 0;
+    for(uint64_t begin = seedBegin; begin < seedEnd; begin += SEED_BLOCK){
+        queues[next].push(begin, min(begin + SEED_BLOCK, seedEnd));
+        next = (next + 1) % threads;
+    }
+    vector<Worker*> workers;
+    for(int i = 0; i < threads; i++){
+        workers.push_back(new Worker(rows, cols, mines, policy));
+    }
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> pool;
+    for(int i = 0; i < threads; i++){
+        pool.emplace_back(&Worker::run, workers[i], ref(queues), i);
+    }
+    for(thread& t : pool){
+        t.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    BatchStats total;
+    for(Worker* worker : workers){
+        total.add(worker->getStats());
+        delete worker;
+    }
+    double games = total.games ? double(total.games) : 1;
+    cout << "board: " << rows << "x" << cols << ", " << mines << " mines, density " << double(mines) / (double(rows) * cols) << endl;
+    cout << "policy: " << argv[6] << ", threads: " << threads << endl;
+    cout << "games: " << total.games << ", wins: " << total.wins << ", win rate: " << total.wins / games << endl;
+    cout << "moves per game: " << total.moves / games << endl;
+    cout << "mean opening: " << total.openingCells / games << " cells" << endl;
+    cout << "mean cells opened: " << total.openedCells / games << " cells" << endl;
+    cout << "opening sizes:";
+    for(int i = 0; i < OPENING_BUCKETS; i++){
+        if(total.openingSizes[i]) cout << " [" << (uint64_t(1) << i) << "," << (uint64_t(2) << i) << "): " << total.openingSizes[i];
+    }
+    cout << endl;
+    cout << "time: " << seconds << " s, " << total.games / seconds << " games/s" << endl;
+    if(STATS_ENABLED && !writeStats(statsPath())) cerr << "cannot write " << statsPath() << endl;
+    return EXIT_SUCCESS;
+}
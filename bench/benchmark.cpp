@@ -0,0 +1,422 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include "../board.h"
+#include "../terminalView.h"
+#ifdef MINESWEEPER_BENCH_SDL
+#include "../guiView.h"
+#endif
+using namespace std;
+
+// Benchmark suite for the nightly perf runs. Every board is generated from fixed seeds, so runs
+// are comparable across commits. Prints one JSON document with, per operation, board size and
+// bomb density: ns per call, cells handled per second and heap allocations made while timing,
+// and CPU cycles and branch misses where the kernel exposes hardware counters (null otherwise;
+// most VMs and perf_event_paranoid above 2 hide them).
+//
+//     benchmark [maxSize] [font.ttf]
+//
+// Square boards from 10x10 up to maxSize (default 10000) are timed at each density. Build with
+// -DNDEBUG: debug builds check the win counter against a full scan in checkGameStatus. The
+// offscreen SDL displayBoard is only built with -DMINESWEEPER_BENCH_SDL and draws into a
+// software renderer, so it needs no window or display.
+
+const uint64_t SEED = 20240611;
+const int MAX_MOVES = 100000;
+const long CHECK_CALLS = 10000000;
+
+static size_t allocations = 0;
+static size_t allocatedBytes = 0;
+
+void* operator new(size_t size)
+{
+    allocations++;
+    allocatedBytes += size;
+    void* memory = malloc(size ? size : 1);
+    if(!memory) throw bad_alloc();
+    return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+// One hardware event counted in this thread, user space only, through perf_event_open.
+class PerfCounter{
+    public:
+        PerfCounter(uint64_t event);
+        ~PerfCounter();
+        bool isAvailable() const;
+        void start();
+        // Events since start(), or -1 when the counter is not available.
+        long long stop();
+    private:
+        int m_fd;
+};
+
+PerfCounter::PerfCounter(uint64_t event)
+{
+    perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.config = event;
+    attributes.disabled = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    m_fd = syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+}
+
+PerfCounter::~PerfCounter()
+{
+    if(m_fd >= 0) close(m_fd);
+}
+
+bool PerfCounter::isAvailable() const
+{
+    return m_fd >= 0;
+}
+
+void PerfCounter::start()
+{
+    if(m_fd < 0) return;
+    ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+long long PerfCounter::stop()
+{
+    if(m_fd < 0) return -1;
+    ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+    long long count;
+    if(read(m_fd, &count, sizeof(count)) != sizeof(count)) return -1;
+    return count;
+}
+
+static PerfCounter* cycleCounter;
+static PerfCounter* branchMissCounter;
+
+struct Sample{
+    double seconds;
+    size_t allocations;
+    size_t bytes;
+    long long cycles;           // -1 without hardware counters
+    long long branchMisses;
+};
+
+template<class Body>
+Sample measure(Body body)
+{
+    size_t startAllocations = allocations, startBytes = allocatedBytes;
+    auto start = chrono::steady_clock::now();
+    cycleCounter->start();
+    branchMissCounter->start();
+    body();
+    long long branchMisses = branchMissCounter->stop();
+    long long cycles = cycleCounter->stop();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return Sample{seconds, allocations - startAllocations, allocatedBytes - startBytes, cycles, branchMisses};
+}
+
+// JSON output. `cells` is how many cells the timed calls handled in total; it is left out
+// where it means nothing (the O(1) state checks).
+static bool firstResult = true;
+
+void report(const string& op, const Board& board, double density, long ops, double cells, const Sample& sample)
+{
+    if(ops <= 0) return;
+    char line[512];
+    int length = snprintf(line, sizeof(line),
+        "%s\n    {\"op\": \"%s\", \"rows\": %d, \"cols\": %d, \"density\": %.2f, \"bombs\": %d, \"seed\": %llu, "
+        "\"ops\": %ld, \"ns_per_op\": %.1f, ",
+        firstResult ? "" : ",", op.c_str(), board.getRows(), board.getCols(), density, board.getBombs(),
+        (unsigned long long)SEED, ops, sample.seconds * 1e9 / ops);
+    if(cells > 0) length += snprintf(line + length, sizeof(line) - length, "\"cells_per_s\": %.4g, ", cells / sample.seconds);
+    else length += snprintf(line + length, sizeof(line) - length, "\"cells_per_s\": null, ");
+    length += snprintf(line + length, sizeof(line) - length, "\"allocs\": %zu, \"alloc_bytes\": %zu, \"allocs_per_op\": %.3f, ",
+        sample.allocations, sample.bytes, double(sample.allocations) / ops);
+    if(sample.cycles >= 0 && sample.branchMisses >= 0){
+        snprintf(line + length, sizeof(line) - length, "\"cycles_per_op\": %.1f, \"branch_misses_per_op\": %.3f}",
+            double(sample.cycles) / ops, double(sample.branchMisses) / ops);
+    }
+    else snprintf(line + length, sizeof(line) - length, "\"cycles_per_op\": null, \"branch_misses_per_op\": null}");
+    cout << line;
+    firstResult = false;
+}
+
+void add(Sample& total, const Sample& part)
+{
+    total.seconds += part.seconds;
+    total.allocations += part.allocations;
+    total.bytes += part.bytes;
+    total.cycles = total.cycles < 0 || part.cycles < 0 ? -1 : total.cycles + part.cycles;
+    total.branchMisses = total.branchMisses < 0 || part.branchMisses < 0 ? -1 : total.branchMisses + part.branchMisses;
+}
+
+int opened(const Board& board)
+{
+    return board.getRows() * board.getCols() - board.getBombs() - board.getUnopenedSafe();
+}
+
+// The SDL renderer and glyphs the GUI frames draw into. Only defined in the SDL build; the
+// plain build passes a null pointer.
+struct Offscreen;
+
+#ifdef MINESWEEPER_BENCH_SDL
+struct Offscreen{
+    SDL_Surface* surface;
+    SDL_Renderer* renderer;
+    TTF_Font* font;
+    GlyphAtlas atlas;
+};
+#endif
+
+void benchBoard(int size, double density, Offscreen* offscreen)
+{
+    double cells = double(size) * size;
+    int bombs = int(cells * density);
+    int centre = size / 2;
+    // cheap calls are repeated until about 10M cells have been handled
+    long reps = max(1L, long(1e7 / cells));
+    Board board(size, size, bombs);
+
+    Sample sample = measure([&](){
+        for(long rep = 0; rep < reps; rep++){
+            board.reset();
+            board.setSeed(SEED + rep);
+            board.handleFirstClick(centre, centre);
+        }
+    });
+    report("handleFirstClick", board, density, reps, cells * reps, sample);
+
+    sample = measure([&](){
+        for(long rep = 0; rep < reps; rep++){
+            for(int i = 0; i < size; i++){
+                for(int j = 0; j < size; j++){
+                    board.calculateValue(i, j);
+                }
+            }
+        }
+    });
+    report("calculateValue", board, density, long(cells * reps), cells * reps, sample);
+
+    // the opening from the first click, with mine placement and counting left out of the timing
+    Sample fill = {0, 0, 0, 0, 0};
+    double filled = 0;
+    for(long rep = 0; rep < reps; rep++){
+        board.reset();
+        board.setSeed(SEED + rep);
+        board.placeMines(centre, centre);
+        board.calculateValues();
+        add(fill, measure([&](){ board.floodFill(centre, centre); }));
+        filled += opened(board);
+    }
+    report("floodFill", board, density, reps, filled, fill);
+
+    // opens safe cells in a fixed random order until the board is cleared or MAX_MOVES is hit
+    board.reset();
+    board.setSeed(SEED);
+    board.handleFirstClick(centre, centre);
+    vector<int> moves;
+    for(int cell = 0; cell < size * size; cell++){
+        const Cell& c = board.getCell(cell / size, cell % size);
+        if(!c.isBomb() && !c.isOpened()) moves.push_back(cell);
+    }
+    Random random(SEED);
+    for(int i = moves.size() - 1; i > 0; i--){
+        swap(moves[i], moves[random.below(i + 1)]);
+    }
+    if((int)moves.size() > MAX_MOVES) moves.resize(MAX_MOVES);
+    int before = opened(board);
+    sample = measure([&](){
+        for(int cell : moves){
+            board.processMove(cell / size, cell % size);
+        }
+    });
+    report("processMove", board, density, moves.size(), opened(board) - before, sample);
+
+    // chords every number around the first opening once all of its bombs are flagged
+    board.reset();
+    board.setSeed(SEED);
+    board.handleFirstClick(centre, centre);
+    vector<int> numbers;
+    for(int cell = 0; cell < size * size; cell++){
+        const Cell& c = board.getCell(cell / size, cell % size);
+        if(c.isBomb()) board.flagCell(cell / size, cell % size);
+        else if(c.isOpened() && c.getCount() > 0) numbers.push_back(cell);
+    }
+    if((int)numbers.size() > MAX_MOVES) numbers.resize(MAX_MOVES);
+    before = opened(board);
+    sample = measure([&](){
+        for(int cell : numbers){
+            board.chordCell(cell / size, cell % size);
+        }
+    });
+    report("chordCell", board, density, numbers.size(), opened(board) - before, sample);
+
+    volatile int sink = 0;
+    sample = measure([&](){
+        for(long call = 0; call < CHECK_CALLS; call++){
+            sink += board.checkGameStatus();
+        }
+    });
+    report("checkGameStatus", board, density, CHECK_CALLS, 0, sample);
+    sample = measure([&](){
+        for(long call = 0; call < CHECK_CALLS; call++){
+            sink += board.stillPlaying();
+        }
+    });
+    report("stillPlaying", board, density, CHECK_CALLS, 0, sample);
+
+    // a terminal is never wider than a thousand columns, so larger boards are not drawn
+    if(size <= 1000){
+        int out = open("/dev/null", O_WRONLY);
+        TerminalRenderer renderer(out, INT_MAX);
+        long frames = max(1L, long(1e6 / cells));
+        sample = measure([&](){
+            for(long frame = 0; frame < frames; frame++){
+                renderer.invalidate();
+                renderer.draw(board, false);
+            }
+        });
+        report("terminal displayBoard", board, density, frames, cells * frames, sample);
+
+        // one move per frame, drawn as a diff against the frame before
+        board.reset();
+        board.setSeed(SEED);
+        board.handleFirstClick(centre, centre);
+        renderer.draw(board, false);
+        int frameMoves = min<long>(moves.size(), max(10L, long(1e7 / cells)));
+        double changed = 0;
+        Sample diff = {0, 0, 0, 0, 0};
+        for(int i = 0; i < frameMoves; i++){
+            int before = opened(board);
+            board.processMove(moves[i] / size, moves[i] % size);
+            changed += opened(board) - before;
+            add(diff, measure([&](){ renderer.draw(board, false); }));
+        }
+        report("terminal displayBoard diff", board, density, frameMoves, changed, diff);
+        close(out);
+    }
+
+    // the GUI's 530 pixel viewport at the default zoom, which fits small boards and shows
+    // large ones at two to three pixels a cell
+    if(offscreen){
+#ifdef MINESWEEPER_BENCH_SDL
+        Camera camera({70, 150, 530, 530}, size, size);
+        long frames = 200;
+        double drawn = 0;
+        sample = measure([&](){
+            for(long frame = 0; frame < frames; frame++){
+                displayBoard(offscreen->renderer, offscreen->atlas, board, camera);
+                SDL_RenderPresent(offscreen->renderer);
+            }
+        });
+        int firstRow, lastRow, firstCol, lastCol;
+        camera.visibleCells(firstRow, lastRow, firstCol, lastCol);
+        double visible = double(lastRow - firstRow) * (lastCol - firstCol);
+        report("sdl displayBoard", board, density, frames, visible * frames, sample);
+
+        // panning redraws the whole view every frame
+        sample = measure([&](){
+            for(long frame = 0; frame < frames; frame++){
+                camera.pan(frame % 100 < 50 ? 7 : -7, 3);
+                drawn += drawBoardView(offscreen->renderer, offscreen->atlas, board, camera);
+                SDL_RenderPresent(offscreen->renderer);
+            }
+        });
+        report("sdl pan frame", board, density, frames, drawn, sample);
+
+        // the GUI's per-move frame: only the cells the move changed are redrawn
+        vector<int> changed;
+        board.reset();
+        board.setSeed(SEED);
+        board.handleFirstClick(centre, centre);
+        board.trackChanges(&changed);
+        Sample dirty = {0, 0, 0, 0, 0};
+        double redrawn = 0;
+        int dirtyMoves = min<long>(moves.size(), 1000);
+        for(int i = 0; i < dirtyMoves; i++){
+            board.processMove(moves[i] / size, moves[i] % size);
+            redrawn += changed.size();
+            add(dirty, measure([&](){
+                for(int index : changed){
+                    drawCell(offscreen->renderer, offscreen->atlas, board, camera, index / size, index % size);
+                }
+                SDL_RenderPresent(offscreen->renderer);
+            }));
+            changed.clear();
+        }
+        board.trackChanges(nullptr);
+        report("sdl dirty frame", board, density, dirtyMoves, redrawn, dirty);
+#endif
+    }
+}
+
+int main(int argc, char* argv[]){
+    int maxSize = argc > 1 ? atoi(argv[1]) : 10000;
+    const int sizes[] = {10, 100, 1000, 10000};
+    const double densities[] = {0.0, 0.10, 0.16, 0.20};
+
+    PerfCounter cycles(PERF_COUNT_HW_CPU_CYCLES), branchMisses(PERF_COUNT_HW_BRANCH_MISSES);
+    cycleCounter = &cycles;
+    branchMissCounter = &branchMisses;
+    if(!cycles.isAvailable() || !branchMisses.isAvailable()){
+        cerr << "no hardware counters (perf_event_open: " << strerror(errno) << "), cycles and branch misses are null" << endl;
+    }
+
+    Offscreen* offscreen = nullptr;
+#ifdef MINESWEEPER_BENCH_SDL
+    Offscreen target;
+    const char* fontPath = argc > 2 ? argv[2] : "src/include/SDL2/Roboto-Medium.ttf";
+    if(TTF_Init() < 0){
+        cerr << "TTF initialization failed: " << TTF_GetError() << endl;
+        return EXIT_FAILURE;
+    }
+    target.surface = SDL_CreateRGBSurfaceWithFormat(0, 670, 750, 32, SDL_PIXELFORMAT_ARGB8888);
+    target.renderer = SDL_CreateSoftwareRenderer(target.surface);
+    target.font = TTF_OpenFont(fontPath, 20);
+    if(!target.surface || !target.renderer || !target.font || !target.atlas.build(target.renderer, target.font)){
+        cerr << "offscreen SDL setup failed: " << SDL_GetError() << endl;
+        return EXIT_FAILURE;
+    }
+    offscreen = &target;
+#endif
+
+    cout << "{\"benchmark\": \"minesweeper\", \"results\": [";
+    for(int size : sizes){
+        if(size > maxSize) break;
+        for(double density : densities){
+            benchBoard(size, density, offscreen);
+        }
+    }
+    cout << "\n]}" << endl;
+
+#ifdef MINESWEEPER_BENCH_SDL
+    TTF_CloseFont(target.font);
+    target.atlas.clear();
+    SDL_DestroyRenderer(target.renderer);
+    SDL_FreeSurface(target.surface);
+    TTF_Quit();
+#endif
+    return EXIT_SUCCESS;
+}
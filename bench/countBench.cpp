@@ -0,0 +1,65 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include "../board.h"
+using namespace std;
+
+// Times the per-cell calculateValue loop against each available count kernel on square boards
+// of 1K to 100M cells at 16% density, checking that every kernel agrees with the per-cell counts.
+int benchCount()
+{
+    const int sizes[] = {32, 100, 316, 1000, 3162, 10000};
+    const char* names[] = {"scalar", "sse2", "avx2"};
+    CountRowFn kernels[] = {countRowScalar, nullptr, nullptr};
+#ifdef MINESWEEPER_X86
+    if(__builtin_cpu_supports("sse2")) kernels[1] = countRowSSE2;
+    if(__builtin_cpu_supports("avx2")) kernels[2] = countRowAVX2;
+#endif
+    for(int size : sizes){
+        Board board(size, size, size * size / 100 * 16);
+        board.setSeed(1);
+        board.placeMines(size / 2, size / 2);
+        double cells = double(size) * size;
+        int reps = cells < 1e7 ? int(1e7 / cells) : 1;
+
+        auto start = chrono::steady_clock::now();
+        for(int rep = 0; rep < reps; rep++){
+            for(int i = 0; i < size; i++){
+                for(int j = 0; j < size; j++){
+                    board.calculateValue(i, j);
+                }
+            }
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << size * size << " cells: per-cell " << cells * reps / seconds << " cells/s";
+
+        vector<unsigned char> expected(size * size);
+        for(int i = 0; i < size; i++){
+            for(int j = 0; j < size; j++){
+                expected[i * size + j] = board.getCell(i, j).getCount();
+            }
+        }
+        for(int k = 0; k < 3; k++){
+            if(!kernels[k]) continue;
+            start = chrono::steady_clock::now();
+            for(int rep = 0; rep < reps; rep++){
+                board.calculateValues(kernels[k]);
+            }
+            seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << ", " << names[k] << " " << cells * reps / seconds << " cells/s";
+            for(int i = 0; i < size * size; i++){
+                if(board.getCell(i / size, i % size).getCount() != expected[i]){
+                    cout << endl << names[k] << " kernel disagrees with calculateValue" << endl;
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+        cout << endl;
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(){
+    return benchCount();
+}
@@ -0,0 +1,41 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include "../endless.h"
+using namespace std;
+
+// Clears ever larger squares around the origin of an endless board with 16% bombs, opening
+// every safe cell ring by ring and flagging every bomb (the bench peeks at the bombs). Reports
+// how memory grows against the explored area: resolved chunks keep at most their flags, so it
+// should follow the perimeter rather than the area.
+int main(int argc, char* argv[]){
+    int radius = argc > 1 ? atoi(argv[1]) : 2000;
+    EndlessBoard board(1, EndlessBoard::CHUNK_CELLS * 16 / 100);
+    board.processMove(0, 0);
+    auto start = chrono::steady_clock::now();
+    int report = 125;
+    for(int64_t ring = 1; ring <= radius; ring++){
+        for(int64_t r = -ring; r <= ring; r++){
+            int64_t step = (r == -ring || r == ring) ? 1 : 2 * ring;
+            for(int64_t c = -ring; c <= ring; c += step){
+                const Cell& cell = board.getCell(r, c);
+                if(cell.isOpened() || cell.getFlag()) continue;
+                if(cell.isBomb()) board.flagCell(r, c);
+                else board.processMove(r, c);
+            }
+        }
+        if(ring == report || ring == radius){
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            double explored = double(2 * ring + 1) * (2 * ring + 1);
+            cout << "explored " << 2 * ring + 1 << "x" << 2 * ring + 1 << ": " << board.getChunkCount() << " chunks, "
+                 << board.getResolvedCount() << " resolved, " << board.getMemoryUsage() / 1024 << " KB ("
+                 << board.getMemoryUsage() / explored << " bytes/cell), " << explored / seconds << " cells/s" << endl;
+            report *= 2;
+        }
+    }
+    if(!board.stillPlaying()){
+        cout << "opened a bomb" << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
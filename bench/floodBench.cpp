@@ -0,0 +1,26 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include "../board.h"
+using namespace std;
+
+// Opens an empty size x size board with a single click and reports how fast the fill ran.
+int benchFlood(int size)
+{
+    Board board(size, size, 0);
+    auto start = chrono::steady_clock::now();
+    board.floodFill(size / 2, size / 2);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    double cells = double(size) * size;
+    cout << "flood fill " << size << "x" << size << ": " << seconds * 1000 << " ms, " << cells / seconds << " cells/s" << endl;
+    if(!board.checkGameStatus()){
+        cout << "flood fill left cells unopened" << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[]){
+    return benchFlood(argc > 1 ? atoi(argv[1]) : 10000);
+}
@@ -0,0 +1,65 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "../board.h"
+#include "../noguess.h"
+using namespace std;
+
+// Expert boards (16x30, 99 bombs) clicked in the middle. First times searching for a no-guess
+// seed on demand with every core, then times serving seeds from a warm pool. Every served seed
+// is checked to really deal a no-guess board.
+int main(int argc, char* argv[]){
+    int boards = argc > 1 ? atoi(argv[1]) : 200;
+    int threads = max(1u, thread::hardware_concurrency());
+    const int rows = 16, cols = 30, bombs = 99, row = 8, col = 15;
+
+    vector<double> search;
+    uint64_t next = 0;
+    for(int i = 0; i < boards; i++){
+        auto start = chrono::steady_clock::now();
+        uint64_t seed;
+        if(!findNoGuessSeed(rows, cols, bombs, row, col, next, threads, seed)){
+            cerr << "no no-guess seed among " << NO_GUESS_ATTEMPTS << " candidates from " << next << endl;
+            return EXIT_FAILURE;
+        }
+        search.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        next = seed + 1;
+    }
+
+    NoGuessPool pool(threads, boards, 1000000);
+    pool.prepare(rows, cols, bombs, row, col);
+    while(pool.ready(rows, cols, bombs, row, col) < boards){
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    vector<double> serve;
+    vector<uint64_t> seeds;
+    for(int i = 0; i < boards; i++){
+        auto start = chrono::steady_clock::now();
+        uint64_t seed;
+        if(!pool.take(rows, cols, bombs, row, col, seed)){
+            cerr << "the pool gave up on expert boards" << endl;
+            return EXIT_FAILURE;
+        }
+        seeds.push_back(seed);
+        serve.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+    }
+    Board scratch(rows, cols, bombs);
+    Solver solver;
+    int bad = 0;
+    for(uint64_t seed : seeds){
+        if(!isNoGuess(scratch, solver, seed, row, col)) bad++;
+    }
+
+    sort(search.begin(), search.end());
+    sort(serve.begin(), serve.end());
+    cout << "expert no-guess boards: " << boards << ", threads: " << threads << endl;
+    cout << "on demand ms: p50 " << search[boards / 2] << ", p99 " << search[boards * 99 / 100]
+         << ", max " << search.back() << endl;
+    cout << "from pool ms: p50 " << serve[boards / 2] << ", p99 " << serve[boards * 99 / 100]
+         << ", max " << serve.back() << endl;
+    cout << "served seeds failing the check: " << bad << endl;
+    return bad == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,99 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include "../board.h"
+#include "../presetboard.h"
+using namespace std;
+
+// Plays the same games on a Board and on the PresetBoard of each standard level and reports
+// ns per game for each, with the bomb count and a full-board flood fill timed on their own.
+// Both boards must end every game in the same state.
+
+struct Timings{
+    double game;
+    double count;
+    double fill;
+    uint64_t hashes;
+};
+
+template<class Run>
+static double nanoseconds(int reps, Run run)
+{
+    auto start = chrono::steady_clock::now();
+    for(int rep = 0; rep < reps; rep++){
+        run(rep);
+    }
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / reps;
+}
+
+// `board` has bombs placed at random; `empty` has none, so one click fills all of it.
+static Timings measure(Board& board, Board& empty, const vector<int>& moves, int games, int movesPerGame)
+{
+    int rows = board.getRows(), cols = board.getCols();
+    Timings timings;
+    timings.hashes = 0;
+    timings.game = nanoseconds(games, [&](int game){
+        board.reset();
+        board.setSeed(game);
+        board.handleFirstClick(rows / 2, cols / 2);
+        const int* move = moves.data() + size_t(game) * movesPerGame;
+        for(int i = 0; i < movesPerGame && board.stillPlaying(); i++){
+            board.processMove(move[i] / cols, move[i] % cols);
+        }
+        timings.hashes ^= board.getStateHash() + game;
+    });
+    timings.count = nanoseconds(games, [&](int){ board.calculateValues(); });
+    timings.fill = nanoseconds(games, [&](int){
+        empty.reset();
+        empty.floodFill(rows / 2, cols / 2);
+    });
+    return timings;
+}
+
+template<int Rows, int Cols>
+static bool benchPreset(int bombs, int games)
+{
+    const int movesPerGame = 40;
+    vector<int> moves(size_t(games) * movesPerGame);
+    Random rng(7);
+    for(int& move : moves){
+        move = rng.below(Rows * Cols);
+    }
+    Board dynamic(Rows, Cols, bombs), dynamicEmpty(Rows, Cols, 0);
+    PresetBoard<Rows, Cols> preset(bombs), presetEmpty(0);
+    // warm up, then time each five times in turn and keep the fastest run, since a fill takes
+    // about a microsecond and one run is easily thrown off by a busy machine
+    measure(dynamic, dynamicEmpty, moves, games / 10, movesPerGame);
+    measure(preset, presetEmpty, moves, games / 10, movesPerGame);
+    Timings best[2];
+    for(int round = 0; round < 5; round++){
+        Timings timings[2] = {measure(dynamic, dynamicEmpty, moves, games, movesPerGame), measure(preset, presetEmpty, moves, games, movesPerGame)};
+        for(int i = 0; i < 2; i++){
+            if(round == 0) best[i] = timings[i];
+            best[i].game = min(best[i].game, timings[i].game);
+            best[i].count = min(best[i].count, timings[i].count);
+            best[i].fill = min(best[i].fill, timings[i].fill);
+        }
+    }
+    const char* names[] = {"dynamic", "preset"};
+    for(int i = 0; i < 2; i++){
+        cout << Rows << "x" << Cols << "/" << bombs << " " << names[i] << ": game " << best[i].game << " ns, count "
+             << best[i].count << " ns, fill " << best[i].fill << " ns" << endl;
+    }
+    cout << "  preset speedup: game " << best[0].game / best[1].game << "x, count " << best[0].count / best[1].count
+         << "x, fill " << best[0].fill / best[1].fill << "x" << endl;
+    if(best[0].hashes != best[1].hashes){
+        cout << "  the boards ended in different states" << endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]){
+    int games = argc > 1 ? atoi(argv[1]) : 200000;
+    bool same = benchPreset<10, 10>(10, games);
+    same = benchPreset<18, 18>(40, games) && same;
+    same = benchPreset<24, 24>(99, games) && same;
+    return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include "../board.h"
+#include "../solver.h"
+#include "../probability.h"
+using namespace std;
+
+// Plays 24x24 boards with 99 bombs using the solver. Every time the solver is stuck it times
+// the probability engine on that position, then opens the safest cell. Stuck positions are the
+// hard ones: the frontier is as large as it gets and nothing is certain.
+int main(int argc, char* argv[]){
+    int games = argc > 1 ? atoi(argv[1]) : 500;
+    const int rows = 24, cols = 24;
+    Board board(rows, cols, 99);
+    Solver solver;
+    ProbabilityEngine engine;
+    vector<int> safe, mines;
+    vector<double> probabilities;
+    vector<double> times;
+    vector<double> largeTimes;
+    int largestFrontier = 0;
+    int wins = 0;
+    for(int seed = 0; seed < games; seed++){
+        board.reset();
+        board.setSeed(seed);
+        board.handleFirstClick(rows / 2, cols / 2);
+        while(board.stillPlaying()){
+            safe.clear();
+            mines.clear();
+            if(!solver.solve(board, safe, mines)){
+                auto start = chrono::steady_clock::now();
+                engine.compute(board, probabilities);
+                double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                times.push_back(ms);
+                if(engine.getFrontierSize() >= 40) largeTimes.push_back(ms);
+                largestFrontier = max(largestFrontier, engine.getFrontierSize());
+                int best = -1;
+                for(int cell = 0; cell < rows * cols; cell++){
+                    const Cell& c = board.getCell(cell / cols, cell % cols);
+                    if(c.isOpened() || c.getFlag()) continue;
+                    if(best < 0 || probabilities[cell] < probabilities[best]) best = cell;
+                }
+                safe.push_back(best);
+            }
+            for(int cell : mines){
+                board.flagCell(cell / cols, cell % cols);
+            }
+            for(int cell : safe){
+                if(board.stillPlaying()) board.processMove(cell / cols, cell % cols);
+            }
+        }
+        if(board.getWin()) wins++;
+    }
+    sort(times.begin(), times.end());
+    sort(largeTimes.begin(), largeTimes.end());
+    double total = 0;
+    for(double ms : times){
+        total += ms;
+    }
+    cout << "24x24/99 games: " << games << ", wins: " << wins << endl;
+    cout << "stuck positions: " << times.size() << ", largest frontier: " << largestFrontier << " cells" << endl;
+    if(times.empty()) return EXIT_SUCCESS;
+    cout << "ms per position: mean " << total / times.size() << ", p50 " << times[times.size() / 2]
+         << ", p99 " << times[times.size() * 99 / 100] << ", max " << times.back() << endl;
+    if(!largeTimes.empty()){
+        cout << "frontier >= 40 cells: " << largeTimes.size() << " positions, p50 " << largeTimes[largeTimes.size() / 2]
+             << " ms, max " << largeTimes.back() << " ms" << endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,196 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <queue>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../board.h"
+using namespace std;
+
+// Load generator for the game server. Opens `sessions` connections at once, and on each plays
+// expert games (16x30, 99 bombs) with one command in flight: mostly random opens, some flags
+// and undos, and a new game whenever one ends. Reports the latency of every move, from send
+// to reply, and the moves per second over all sessions.
+//
+//     serverBench [sessions] [movesPerSession] [--rate movesPerSecond] [--port n | --unix path]
+//
+// Without --rate every session sends its next move as soon as the last is answered, which
+// measures throughput, and the latency is mostly time spent queued behind the other sessions.
+// With --rate each session waits sessions / rate seconds between moves, for the latency of a
+// server that is keeping up.
+
+typedef chrono::steady_clock Clock;
+
+struct Client{
+    int fd;
+    string in;
+    int moves;
+    bool waiting;
+    bool newGame;   // the command in flight starts a game
+    Clock::time_point sent;
+};
+
+static void sendCommand(Client& client, const string& command)
+{
+    client.sent = Clock::now();
+    client.waiting = true;
+    size_t done = 0;
+    while(done < command.size()){
+        ssize_t written = write(client.fd, command.data() + done, command.size() - done);
+        if(written > 0) done += written;
+        else if(written < 0 && errno != EINTR && errno != EAGAIN) return;
+    }
+}
+
+int main(int argc, char* argv[]){
+    int sessions = 2000, movesPerSession = 200, port = 7878;
+    double rate = 0;
+    const char* unixPath = nullptr;
+    vector<int> numbers;
+    for(int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if(arg == "--port" && i + 1 < argc) port = atoi(argv[++i]);
+        else if(arg == "--unix" && i + 1 < argc) unixPath = argv[++i];
+        else if(arg == "--rate" && i + 1 < argc) rate = atof(argv[++i]);
+        else numbers.push_back(atoi(argv[i]));
+    }
+    if(numbers.size() > 0) sessions = numbers[0];
+    if(numbers.size() > 1) movesPerSession = numbers[1];
+    rlimit limit;
+    if(getrlimit(RLIMIT_NOFILE, &limit) == 0){
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    int epoll = epoll_create1(0);
+    vector<Client> clients(sessions);
+    Random rng(20240611);
+    for(int i = 0; i < sessions; i++){
+        Client& client = clients[i];
+        int fd;
+        int connected;
+        if(unixPath){
+            fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            strncpy(address.sun_path, unixPath, sizeof(address.sun_path) - 1);
+            connected = connect(fd, (sockaddr*)&address, sizeof(address));
+        }
+        else{
+            fd = socket(AF_INET, SOCK_STREAM, 0);
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(port);
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            connected = connect(fd, (sockaddr*)&address, sizeof(address));
+        }
+        if(connected != 0){
+            cerr << "cannot connect session " << i << ": " << strerror(errno) << endl;
+            return EXIT_FAILURE;
+        }
+        client.fd = fd;
+        client.moves = 0;
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u32 = i;
+        epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    vector<double> latencies;
+    latencies.reserve(size_t(sessions) * movesPerSession);
+    int active = sessions;
+    // paced moves waiting for their time, soonest first
+    typedef pair<Clock::time_point, int> Due;
+    priority_queue<Due, vector<Due>, greater<Due>> due;
+    Clock::duration interval = chrono::duration_cast<Clock::duration>(chrono::duration<double>(rate > 0 ? sessions / rate : 0));
+    vector<string> pending(sessions);
+    auto start = Clock::now();
+    for(int i = 0; i < sessions; i++){
+        // paced sessions start spread over one interval rather than all at once
+        clients[i].newGame = true;
+        pending[i] = "new 16 30 99 " + to_string(i) + "\n";
+        if(rate > 0) due.push(Due(start + interval * i / sessions, i));
+        else sendCommand(clients[i], pending[i]);
+    }
+    epoll_event events[1024];
+    char chunk[4096];
+    while(active > 0){
+        // epoll_pwait2 for a timeout finer than epoll_wait's milliseconds, which would bunch sends up
+        timespec timeout;
+        timespec* wait = nullptr;
+        if(!due.empty()){
+            long long nanoseconds = max<long long>(0, chrono::duration_cast<chrono::nanoseconds>(due.top().first - Clock::now()).count());
+            timeout.tv_sec = nanoseconds / 1000000000;
+            timeout.tv_nsec = nanoseconds % 1000000000;
+            wait = &timeout;
+        }
+        int count = epoll_pwait2(epoll, events, 1024, wait, nullptr);
+        Clock::time_point now = Clock::now();
+        while(!due.empty() && due.top().first <= now){
+            int i = due.top().second;
+            due.pop();
+            sendCommand(clients[i], pending[i]);
+        }
+        for(int e = 0; e < count; e++){
+            int index = events[e].data.u32;
+            Client& client = clients[index];
+            ssize_t got = read(client.fd, chunk, sizeof(chunk));
+            if(got <= 0){
+                cerr << "the server closed a session" << endl;
+                return EXIT_FAILURE;
+            }
+            client.in.append(chunk, got);
+            size_t newline = client.in.find('\n');
+            if(newline == string::npos) continue;
+            string reply = client.in.substr(0, newline);
+            client.in.erase(0, newline + 1);
+            if(!client.newGame){
+                latencies.push_back(chrono::duration<double, micro>(Clock::now() - client.sent).count());
+                client.moves++;
+            }
+            if(client.moves == movesPerSession){
+                close(client.fd);
+                active--;
+                continue;
+            }
+            // a finished game, or a reply that is not a move result, starts a new game
+            client.newGame = reply.find(" playing ") == string::npos;
+            if(client.newGame){
+                sendCommand(client, "new 16 30 99 " + to_string(rng.below(1000000)) + "\n");
+                continue;
+            }
+            uint32_t pick = rng.below(100);
+            string command = pick < 80 ? "o " : pick < 95 ? "f " : "u";
+            if(pick < 95) command += to_string(rng.below(16)) + " " + to_string(rng.below(30));
+            command += "\n";
+            Clock::time_point next = client.sent + interval;
+            if(next > Clock::now()){
+                pending[index] = command;
+                due.push(Due(next, index));
+            }
+            else sendCommand(client, command);
+        }
+    }
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p){ return latencies[min(latencies.size() - 1, size_t(p * latencies.size()))]; };
+    cout << sessions << " sessions, " << latencies.size() << " moves in " << seconds << " s: "
+         << latencies.size() / seconds << " moves/s" << endl;
+    cout << "latency p50 " << percentile(0.50) << " us, p99 " << percentile(0.99) << " us, max " << latencies.back() << " us" << endl;
+    close(epoll);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,61 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "../board.h"
+#include "../snapshot.h"
+using namespace std;
+
+double millisSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// A 10000x10000 board (100M cells) at 16% bombs, part played: saves it, maps it back in, and
+// checks every cell and counter against the original. Also times the first full pass over the
+// loaded cells, which is when the pages are actually read in.
+int main(int argc, char* argv[]){
+    int size = argc > 1 ? atoi(argv[1]) : 10000;
+    string path = argc > 2 ? argv[2] : "snapshotBench.snap";
+    Board board(size, size, int(double(size) * size * 0.16));
+    board.setSeed(20240611);
+    board.handleFirstClick(size / 2, size / 2);
+    for(int i = 0; i < size; i += 7){
+        const Cell& cell = board.getCell(i, size - 1 - i);
+        if(cell.isBomb()) board.flagCell(i, size - 1 - i);
+        else board.processMove(i, size - 1 - i);
+    }
+
+    Snapshot snapshot;
+    auto start = chrono::steady_clock::now();
+    if(!snapshot.save(board, path)){
+        cerr << snapshot.getError() << endl;
+        return EXIT_FAILURE;
+    }
+    double save = millisSince(start);
+
+    start = chrono::steady_clock::now();
+    if(!snapshot.load(path)){
+        cerr << snapshot.getError() << endl;
+        return EXIT_FAILURE;
+    }
+    double load = millisSince(start);
+
+    const Board& loaded = *snapshot.getBoard();
+    start = chrono::steady_clock::now();
+    // the whole grid, from the top-left sentinel, so the ring is compared too
+    const size_t corner = size_t(size) + 2 + 1;
+    bool same = memcmp(&loaded.getCell(0, 0) - corner, &board.getCell(0, 0) - corner, Board::gridCells(size, size)) == 0;
+    double firstPass = millisSince(start);
+    same = same && loaded.getRows() == board.getRows() && loaded.getCols() == board.getCols()
+        && loaded.getBombs() == board.getBombs() && loaded.getFlagCount() == board.getFlagCount()
+        && loaded.getUnopenedSafe() == board.getUnopenedSafe() && loaded.getState() == board.getState()
+        && loaded.getSeed() == board.getSeed();
+
+    cout << size << "x" << size << ": save " << save << " ms, load " << load << " ms, first pass over the mapped cells "
+         << firstPass << " ms, " << (same ? "identical" : "MISMATCH") << endl;
+    remove(path.c_str());
+    return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,56 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include "../board.h"
+#include "../solver.h"
+using namespace std;
+
+// Plays expert boards (16 rows x 30 columns, 99 bombs) with the solver, guessing at random
+// when it is stuck, and times every deduction round on the positions that come up.
+int main(int argc, char* argv[]){
+    int games = argc > 1 ? atoi(argv[1]) : 2000;
+    Board board(16, 30, 99);
+    Solver solver;
+    vector<int> safe, mines;
+    vector<double> rounds;
+    int wins = 0;
+    for(int seed = 0; seed < games; seed++){
+        Random rng(seed);
+        board.reset();
+        board.setSeed(seed);
+        board.handleFirstClick(8, 15);
+        while(board.stillPlaying()){
+            safe.clear();
+            mines.clear();
+            auto start = chrono::steady_clock::now();
+            bool progress = solver.solve(board, safe, mines);
+            rounds.push_back(chrono::duration<double, nano>(chrono::steady_clock::now() - start).count());
+            if(!progress){
+                int cell;
+                do{
+                    cell = rng.below(16 * 30);
+                }while(board.getCell(cell / 30, cell % 30).isOpened() || board.getCell(cell / 30, cell % 30).getFlag());
+                safe.push_back(cell);
+            }
+            for(int cell : mines){
+                board.flagCell(cell / 30, cell % 30);
+            }
+            for(int cell : safe){
+                if(board.stillPlaying()) board.processMove(cell / 30, cell % 30);
+            }
+        }
+        if(board.getWin()) wins++;
+    }
+    double total = 0;
+    for(double ns : rounds){
+        total += ns;
+    }
+    sort(rounds.begin(), rounds.end());
+    cout << "expert games: " << games << ", wins: " << wins << endl;
+    cout << "deduction rounds: " << rounds.size() << endl;
+    cout << "ns per round: mean " << total / rounds.size() << ", p50 " << rounds[rounds.size() / 2]
+         << ", p99 " << rounds[rounds.size() * 99 / 100] << ", max " << rounds.back() << endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,549 @@
+#include "board.h"
+#include "history.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <chrono>
+#ifdef MINESWEEPER_X86
+#include <immintrin.h>
+#endif
+using namespace std;
+
+Random::Random(uint64_t seed)
+{
+    for(int i = 0; i < 4; i++){
+        seed += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        m_state[i] = z ^ (z >> 31);
+    }
+}
+
+uint64_t Random::next()
+{
+    uint64_t result = m_state[1] * 5;
+    result = ((result << 7) | (result >> 57)) * 9;
+    uint64_t t = m_state[1] << 17;
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= t;
+    m_state[3] = (m_state[3] << 45) | (m_state[3] >> 19);
+    return result;
+}
+
+// Uniform value in [0, bound) using Lemire's multiply-and-reject, which avoids modulo bias.
+uint32_t Random::below(uint32_t bound)
+{
+    uint64_t product = (next() >> 32) * bound;
+    uint32_t low = (uint32_t)product;
+    if(low < bound){
+        uint32_t threshold = -bound % bound;
+        while(low < threshold){
+            product = (next() >> 32) * bound;
+            low = (uint32_t)product;
+        }
+    }
+    return product >> 32;
+}
+
+// Whole-board neighbour counting. Each row is done as a separable 3x3 box sum: the bomb bits
+// (0x10) of the rows above, at and below are summed column-wise into a zero-padded row of
+// partial sums, then three adjacent partial sums are added and the cell's own bomb removed.
+// Nine bombs sum to 0x90, so the byte lanes never overflow and the count is the high nibble.
+void countRowScalar(unsigned char* cur, const unsigned char* prev, const unsigned char* next, unsigned char* sums, int cols)
+{
+    for(int c = 0; c < cols; c++){
+        sums[c+1] = (prev[c] & 0x10) + (cur[c] & 0x10) + (next[c] & 0x10);
+    }
+    for(int c = 0; c < cols; c++){
+        int total = sums[c] + sums[c+1] + sums[c+2] - (cur[c] & 0x10);
+        cur[c] = (cur[c] & 0xF0) | (total >> 4);
+    }
+}
+
+#ifdef MINESWEEPER_X86
+__attribute__((target("sse2")))
+void countRowSSE2(unsigned char* cur, const unsigned char* prev, const unsigned char* next, unsigned char* sums, int cols)
+{
+    const __m128i bomb = _mm_set1_epi8(0x10);
+    const __m128i low = _mm_set1_epi8(0x0F);
+    const __m128i high = _mm_set1_epi8((char)0xF0);
+    int c = 0;
+    for(; c + 16 <= cols; c += 16){
+        __m128i sum = _mm_add_epi8(_mm_and_si128(_mm_loadu_si128((const __m128i*)(prev + c)), bomb),
+                      _mm_add_epi8(_mm_and_si128(_mm_loadu_si128((const __m128i*)(cur + c)), bomb),
+                                   _mm_and_si128(_mm_loadu_si128((const __m128i*)(next + c)), bomb)));
+        _mm_storeu_si128((__m128i*)(sums + c + 1), sum);
+    }
+    for(; c < cols; c++){
+        sums[c+1] = (prev[c] & 0x10) + (cur[c] & 0x10) + (next[c] & 0x10);
+    }
+    for(c = 0; c + 16 <= cols; c += 16){
+        __m128i cells = _mm_loadu_si128((const __m128i*)(cur + c));
+        __m128i total = _mm_add_epi8(_mm_loadu_si128((const __m128i*)(sums + c)),
+                        _mm_add_epi8(_mm_loadu_si128((const __m128i*)(sums + c + 1)),
+                                     _mm_loadu_si128((const __m128i*)(sums + c + 2))));
+        total = _mm_sub_epi8(total, _mm_and_si128(cells, bomb));
+        __m128i count = _mm_and_si128(_mm_srli_epi16(total, 4), low);
+        _mm_storeu_si128((__m128i*)(cur + c), _mm_or_si128(_mm_and_si128(cells, high), count));
+    }
+    for(; c < cols; c++){
+        int total = sums[c] + sums[c+1] + sums[c+2] - (cur[c] & 0x10);
+        cur[c] = (cur[c] & 0xF0) | (total >> 4);
+    }
+}
+
+__attribute__((target("avx2")))
+void countRowAVX2(unsigned char* cur, const unsigned char* prev, const unsigned char* next, unsigned char* sums, int cols)
+{
+    const __m256i bomb = _mm256_set1_epi8(0x10);
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    const __m256i high = _mm256_set1_epi8((char)0xF0);
+    int c = 0;
+    for(; c + 32 <= cols; c += 32){
+        __m256i sum = _mm256_add_epi8(_mm256_and_si256(_mm256_loadu_si256((const __m256i*)(prev + c)), bomb),
+                      _mm256_add_epi8(_mm256_and_si256(_mm256_loadu_si256((const __m256i*)(cur + c)), bomb),
+                                      _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(next + c)), bomb)));
+        _mm256_storeu_si256((__m256i*)(sums + c + 1), sum);
+    }
+    for(; c < cols; c++){
+        sums[c+1] = (prev[c] & 0x10) + (cur[c] & 0x10) + (next[c] & 0x10);
+    }
+    for(c = 0; c + 32 <= cols; c += 32){
+        __m256i cells = _mm256_loadu_si256((const __m256i*)(cur + c));
+        __m256i total = _mm256_add_epi8(_mm256_loadu_si256((const __m256i*)(sums + c)),
+                        _mm256_add_epi8(_mm256_loadu_si256((const __m256i*)(sums + c + 1)),
+                                        _mm256_loadu_si256((const __m256i*)(sums + c + 2))));
+        total = _mm256_sub_epi8(total, _mm256_and_si256(cells, bomb));
+        __m256i count = _mm256_and_si256(_mm256_srli_epi16(total, 4), low);
+        _mm256_storeu_si256((__m256i*)(cur + c), _mm256_or_si256(_mm256_and_si256(cells, high), count));
+    }
+    for(; c < cols; c++){
+        int total = sums[c] + sums[c+1] + sums[c+2] - (cur[c] & 0x10);
+        cur[c] = (cur[c] & 0xF0) | (total >> 4);
+    }
+}
+#endif
+
+CountRowFn bestCountRow()
+{
+#ifdef MINESWEEPER_X86
+    if(__builtin_cpu_supports("avx2")) return countRowAVX2;
+    if(__builtin_cpu_supports("sse2")) return countRowSSE2;
+#endif
+    return countRowScalar;
+}
+
+Board::Board(int rows, int cols, int bombs) : Board(rows, cols, bombs, new Cell[gridCells(rows, cols)])
+{
+    m_ownsGrid = true;
+    markSentinels();
+}
+
+Board::Board(int rows, int cols, int bombs, Cell* grid)
+{
+    m_bombs = bombs;
+    m_requestedBombs = bombs;
+    m_rows = rows;
+    m_cols = cols;
+    m_stride = cols + 2;
+    m_cells = grid;
+    m_grid = grid + m_stride + 1;
+    const int neighbours[8] = {-m_stride - 1, -m_stride, -m_stride + 1, -1, 1, m_stride - 1, m_stride, m_stride + 1};
+    copy(neighbours, neighbours + 8, m_neighbours);
+    m_ownsGrid = false;
+    bombsFlagged = 0;
+    m_unopenedSafe = rows * cols - bombs;
+    m_minesPlaced = false;
+    m_state = GAME_PLAYING;
+    m_seed = chrono::high_resolution_clock::now().time_since_epoch().count();
+    m_stateHash = 0;
+    m_changed = nullptr;
+    m_history = nullptr;
+    m_kernels = nullptr;
+}
+
+Board::~Board()
+{
+    if(m_ownsGrid) delete[] m_cells;
+}
+
+size_t Board::gridCells(int rows, int cols)
+{
+    return size_t(rows + 2) * (cols + 2);
+}
+
+int Board::cellNumber(int index) const
+{
+    return index / m_stride * m_cols + index % m_stride;
+}
+
+// Every sentinel becomes an open cell with no bomb, flag or count, whatever it held before.
+void Board::markSentinels()
+{
+    Cell sentinel;
+    sentinel.openCell();
+    Cell* bottom = m_grid + m_rows * m_stride - 1;
+    for(int c = 0; c < m_stride; c++){
+        m_cells[c] = sentinel;
+        bottom[c] = sentinel;
+    }
+    for(int r = 0; r < m_rows; r++){
+        m_grid[r * m_stride - 1] = sentinel;
+        m_grid[r * m_stride + m_cols] = sentinel;
+    }
+}
+
+bool Board::sentinelsIntact() const
+{
+    Cell sentinel;
+    sentinel.openCell();
+    unsigned char expected = *reinterpret_cast<const unsigned char*>(&sentinel);
+    const unsigned char* cells = reinterpret_cast<const unsigned char*>(m_cells);
+    const unsigned char* bottom = reinterpret_cast<const unsigned char*>(m_grid + m_rows * m_stride - 1);
+    unsigned char differs = 0;
+    for(int c = 0; c < m_stride; c++){
+        differs |= (cells[c] ^ expected) | (bottom[c] ^ expected);
+    }
+    // a row's right sentinel and the next row's left one are neighbours, from the top ring row
+    // to the bottom one
+    const unsigned char* side = reinterpret_cast<const unsigned char*>(m_grid - m_stride + m_cols);
+    for(int r = -1; r < m_rows; r++, side += m_stride){
+        differs |= (side[0] ^ expected) | (side[1] ^ expected);
+    }
+    return differs == 0;
+}
+
+// Clears the board for a new game without giving its memory back.
+void Board::reset()
+{
+    memset(static_cast<void*>(m_cells), 0, gridCells(m_rows, m_cols));
+    markSentinels();
+    m_bombs = m_requestedBombs;
+    bombsFlagged = 0;
+    m_unopenedSafe = m_rows * m_cols - m_bombs;
+    m_minesPlaced = false;
+    m_state = GAME_PLAYING;
+    m_stateHash = 0;
+    if(m_history) m_history->clear();
+}
+
+// Hands a cell openCell has just opened to whatever is tracking changes or history.
+void Board::recordOpened(int index)
+{
+    if(m_changed) m_changed->push_back(cellNumber(index));
+    if(m_history) m_history->push(index);
+}
+
+MoveResult Board::moveResult() const
+{
+    if(m_state == GAME_LOST) return MOVE_BOMB;
+    if(m_state == GAME_WON) return MOVE_WON;
+    return MOVE_OK;
+}
+
+// Full scan used to cross-check the running counter in debug builds.
+int Board::countUnopenedSafe() const
+{
+    int count = 0;
+    const Cell* end = m_cells + gridCells(m_rows, m_cols);
+    for(const Cell* cell = m_cells; cell != end; cell++){
+        if(!cell->isOpened() && !cell->isBomb()) count++;
+    }
+    return count;
+}
+
+void Board::calculateValue(int row, int col)
+{
+    Cell* cell = m_grid + index(row, col);
+    int valueCounter = 0;
+    for(int offset : m_neighbours){
+        valueCounter += cell[offset].isBomb();
+    }
+    cell->setCount(valueCounter);
+}
+
+void Board::calculateValues()
+{
+    if(m_kernels) m_kernels->calculateValues(*this);
+    else calculateValues(bestCountRow());
+}
+
+void Board::calculateValues(CountRowFn countRow)
+{
+    unsigned char* cells = reinterpret_cast<unsigned char*>(m_grid);
+    // the sentinel rows above and below the board hold no bombs; the sums row is zero padded
+    m_countScratch.assign(m_cols + 2, 0);
+    unsigned char* sums = m_countScratch.data();
+    for(int r = 0; r < m_rows; r++){
+        unsigned char* cur = cells + r * m_stride;
+        countRow(cur, cur - m_stride, cur + m_stride, sums, m_cols);
+    }
+}
+
+// Floyd's sample of m_bombs cells out of every cell outside the 3x3 block around the first
+// click. Runs in time linear in the bomb count and is fully determined by the board's seed.
+void Board::placeMines(int row, int col)
+{
+    int excluded[9];
+    int numExcluded = 0;
+    for(int r = row - 1; r <= row + 1; r++){
+        for(int c = col - 1; c <= col + 1; c++){
+            if(r >= 0 && r < m_rows && c >= 0 && c < m_cols) excluded[numExcluded++] = r * m_cols + c;
+        }
+    }
+    // cells are numbered row * cols + col here, so the mines a seed gives do not depend on
+    // how the grid is stored
+    int candidates = m_rows * m_cols - numExcluded;
+    m_bombs = min(m_requestedBombs, candidates);
+    Random rng(m_seed);
+    for(int j = candidates - m_bombs; j < candidates; j++){
+        int pick = candidateCell(rng.below(j + 1), excluded, numExcluded);
+        Cell* cell = m_grid + index(pick / m_cols, pick % m_cols);
+        if(cell->isBomb()){
+            pick = candidateCell(j, excluded, numExcluded);
+            cell = m_grid + index(pick / m_cols, pick % m_cols);
+        }
+        cell->setBomb(true);
+    }
+    m_unopenedSafe = m_rows * m_cols - m_bombs;
+    m_minesPlaced = true;
+}
+
+// Maps the n-th cell of the candidate list onto the grid by skipping the sorted excluded cells.
+int Board::candidateCell(int n, const int* excluded, int numExcluded) const
+{
+    for(int i = 0; i < numExcluded && n >= excluded[i]; i++){
+        n++;
+    }
+    return n;
+}
+
+MoveResult Board::flagCell(int row, int col)
+{
+    if(row < 0 || row >= m_rows || col < 0 || col >= m_cols) return MOVE_INVALID;
+    Cell& cell = m_grid[index(row, col)];
+    if(cell.isOpened()) return MOVE_ALREADY_OPEN;
+    if(m_history) m_history->begin(History::FLAG, index(row, col), m_state);
+    toggleFlag(index(row, col));
+    return MOVE_OK;
+}
+
+void Board::toggleFlag(int index)
+{
+    Cell& cell = m_grid[index];
+    cell.setFlag(!cell.getFlag());
+    bombsFlagged += cell.getFlag() ? 1 : -1;
+    m_stateHash ^= cellHash(index, FLAG_SHARE);
+    if(m_changed) m_changed->push_back(cellNumber(index));
+}
+
+// The reverse of openCell, for undo.
+void Board::closeCell(int index)
+{
+    Cell& cell = m_grid[index];
+    m_stateHash ^= cellHash(index, *reinterpret_cast<const unsigned char*>(&cell));
+    cell.closeCell();
+    if(!cell.isBomb()) m_unopenedSafe++;
+    if(m_changed) m_changed->push_back(cellNumber(index));
+}
+
+// Walks the last recorded move back. Undoing the first click also lifts the mines, so the
+// next first click is made on an empty board again; flags are kept.
+bool Board::undo()
+{
+    if(!m_history || !m_history->canUndo()) return false;
+    size_t entry = --m_history->m_current;
+    const History::Entry& move = m_history->m_entries[entry];
+    if(move.kind == History::FLAG) toggleFlag(move.cell);
+    for(size_t position = m_history->end(entry); position-- > move.begin;){
+        closeCell(m_history->at(position));
+    }
+    if(move.kind == History::FIRST_CLICK){
+        Cell* end = m_cells + gridCells(m_rows, m_cols);
+        for(Cell* cell = m_cells; cell != end; cell++){
+            cell->setBomb(false);
+            cell->setCount(0);
+        }
+        // every cell is closed again, and the count goes back to the one asked for, so the
+        // next first click deals the board a fresh game would
+        m_bombs = m_requestedBombs;
+        m_unopenedSafe = m_rows * m_cols - m_bombs;
+        m_minesPlaced = false;
+    }
+    m_state = move.before;
+    return true;
+}
+
+// Makes an undone move again from its recorded cells, without searching for them.
+bool Board::redo()
+{
+    if(!m_history || !m_history->canRedo()) return false;
+    size_t entry = m_history->m_current++;
+    const History::Entry& move = m_history->m_entries[entry];
+    if(move.kind == History::FLAG) toggleFlag(move.cell);
+    if(move.kind == History::FIRST_CLICK){
+        placeMines(move.cell / m_stride, move.cell % m_stride);
+        calculateValues();
+    }
+    // the cells are already in the history
+    History* history = m_history;
+    m_history = nullptr;
+    for(size_t position = move.begin; position < history->end(entry); position++){
+        openCell(history->at(position));
+    }
+    m_history = history;
+    return true;
+}
+
+MoveResult Board::processMove(int row, int col)
+{
+    STAT_TIME(STAT_PROCESS_MOVE);
+    if(row < 0 || row >= m_rows || col < 0 || col >= m_cols) return MOVE_INVALID;
+    const Cell& cell = m_grid[index(row, col)];
+    if(cell.isOpened()) return MOVE_ALREADY_OPEN;
+    if(cell.getFlag()) return MOVE_FLAGGED;
+    if(m_history) m_history->begin(History::OPEN, index(row, col), m_state);
+    fill(index(row, col));
+    return moveResult();
+}
+
+// Opens every closed, unflagged neighbour of an open number once as many flags surround it,
+// as a click with both buttons does. A misplaced flag makes it open a bomb.
+MoveResult Board::chordCell(int row, int col)
+{
+    if(row < 0 || row >= m_rows || col < 0 || col >= m_cols) return MOVE_INVALID;
+    const Cell& cell = m_grid[index(row, col)];
+    if(!cell.isOpened() || cell.isBomb() || cell.getCount() == 0) return MOVE_INVALID;
+    int centre = index(row, col);
+    int flags = 0, closed = 0;
+    for(int offset : m_neighbours){
+        const Cell& neighbour = m_grid[centre + offset];
+        flags += neighbour.getFlag();
+        closed += !neighbour.isOpened() && !neighbour.getFlag();
+    }
+    if(flags != cell.getCount()) return MOVE_INVALID;
+    if(closed == 0) return MOVE_ALREADY_OPEN;
+    if(m_history) m_history->begin(History::OPEN, centre, m_state);
+    for(int offset : m_neighbours){
+        fill(centre + offset);
+    }
+    return moveResult();
+}
+
+bool Board::checkMove(int row, int col) const
+{
+    return (row >= 0 && row < m_rows && col >= 0 && col < m_cols && !m_grid[index(row, col)].isOpened());
+}
+
+MoveResult Board::handleFirstClick(int row, int col)
+{
+    STAT_TIME(STAT_FIRST_CLICK);
+    if(!checkMove(row, col)) return MOVE_INVALID;
+    if(m_history) m_history->begin(History::FIRST_CLICK, index(row, col), m_state);
+    placeMines(row, col);
+    calculateValues();
+    floodFill(row, col);
+    return moveResult();
+}
+
+void Board::floodFill(int row, int col)
+{
+    if(row < 0 || col < 0 || row >= m_rows || col >= m_cols) return;
+    fill(index(row, col));
+}
+
+void Board::fill(int index)
+{
+    if(m_kernels) m_kernels->fill(*this, index);
+    else fillFrom(DynamicShape{m_rows, m_cols}, index);
+}
+
+bool Board::checkGameStatus() const
+{
+    STAT_TIME(STAT_WIN_CHECK);
+    assert(!m_minesPlaced || m_unopenedSafe == countUnopenedSafe());
+    return m_unopenedSafe == 0;
+}
+
+bool Board::stillPlaying() const
+{
+    STAT_TIME(STAT_WIN_CHECK);
+    return m_state == GAME_PLAYING;
+}
+
+bool Board::getWin() const
+{
+    return m_state == GAME_WON;
+}
+
+GameState Board::getState() const
+{
+    return m_state;
+}
+
+int Board::getRows() const
+{
+    return m_rows;
+}
+
+int Board::getCols() const
+{
+    return m_cols;
+}
+
+int Board::getBombs() const
+{
+    return m_bombs;
+}
+
+int Board::getRequestedBombs() const
+{
+    return m_requestedBombs;
+}
+
+int Board::getFlagCount() const
+{
+    return bombsFlagged;
+}
+
+int Board::getUnopenedSafe() const
+{
+    return m_unopenedSafe;
+}
+
+void Board::setSeed(uint64_t seed)
+{
+    m_seed = seed;
+}
+
+void Board::trackChanges(vector<int>* changed)
+{
+    m_changed = changed;
+}
+
+void Board::trackHistory(History* history)
+{
+    m_history = history;
+    if(m_history) m_history->clear();
+}
+
+bool Board::getMinesPlaced() const
+{
+    return m_minesPlaced;
+}
+
+uint64_t Board::getSeed() const
+{
+    return m_seed;
+}
+
+uint64_t Board::getStateHash() const
+{
+    return m_stateHash;
+}
+
@@ -0,0 +1,371 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+// Headless Minesweeper engine shared by the terminal and SDL frontends. Nothing in here does
+// any I/O: moves report what happened through MoveResult and the caller decides what to print.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "stats.h"
+
+class History;
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MINESWEEPER_X86
+#endif
+
+enum MoveResult{
+    MOVE_OK,            // the move was applied and the game goes on
+    MOVE_INVALID,       // outside the board
+    MOVE_ALREADY_OPEN,  // the cell is already open
+    MOVE_FLAGGED,       // tried to open a flagged cell
+    MOVE_BOMB,          // opened a bomb, the game is lost
+    MOVE_WON            // opened the last safe cell
+};
+
+enum GameState{
+    GAME_PLAYING,
+    GAME_WON,
+    GAME_LOST
+};
+
+// xoshiro256** seeded through splitmix64, so any 64-bit seed gives a well mixed state.
+class Random{
+    public:
+        Random(uint64_t seed);
+        uint64_t next();
+        uint32_t below(uint32_t bound);
+    private:
+        uint64_t m_state[4];
+};
+
+class Cell{
+    public:
+        Cell();
+        char getValue() const;
+        int getCount() const;
+        void setCount(int count);
+        bool getFlag() const;
+        void setFlag(bool value);
+        char getDisplayValue() const;
+        void setBomb(bool value);
+        bool isBomb() const;
+        bool isOpened() const;
+        void openCell();
+        // Takes the opened bit back off, for undo.
+        void closeCell();
+    private:
+        // one byte per cell: bits 0-3 hold the neighbour count, then the bomb, opened and flag bits
+        enum { COUNT_MASK = 0x0F, BOMB_BIT = 0x10, OPENED_BIT = 0x20, FLAG_BIT = 0x40 };
+        unsigned char m_bits;
+};
+
+static_assert(sizeof(Cell) == 1, "the count kernel works on the raw cell bytes");
+
+typedef void (*CountRowFn)(unsigned char* cur, const unsigned char* prev, const unsigned char* next, unsigned char* sums, int cols);
+void countRowScalar(unsigned char* cur, const unsigned char* prev, const unsigned char* next, unsigned char* sums, int cols);
+#ifdef MINESWEEPER_X86
+void countRowSSE2(unsigned char* cur, const unsigned char* prev, const unsigned char* next, unsigned char* sums, int cols);
+void countRowAVX2(unsigned char* cur, const unsigned char* prev, const unsigned char* next, unsigned char* sums, int cols);
+#endif
+CountRowFn bestCountRow();
+
+// A board size read at run time.
+struct DynamicShape{
+    int rows;
+    int cols;
+};
+
+// A board size fixed at compile time, so loops over the board have constant bounds and
+// splitting an index into row and column divides by a constant.
+template<int Rows, int Cols>
+struct FixedShape{
+    static constexpr int rows = Rows;
+    static constexpr int cols = Cols;
+};
+
+class Board{
+    public:
+        Board(int rows, int cols, int bombs);
+        // A board on gridCells(rows, cols) cells allocated by the caller, such as a mapped
+        // snapshot or an arena. They must already hold a game, or be given a new one by reset().
+        // The board never frees them.
+        Board(int rows, int cols, int bombs, Cell* grid);
+        // Cells in a board's grid: the board's own, and a ring of sentinels around them.
+        static size_t gridCells(int rows, int cols);
+        virtual ~Board();
+        void reset();
+        void calculateValue(int row, int col);
+        // Counts every cell's neighbouring bombs, with the kernel compiled for this board's size
+        // on a PresetBoard and the best count kernel for the CPU otherwise.
+        void calculateValues();
+        void calculateValues(CountRowFn countRow);
+        MoveResult flagCell(int row, int col);
+        MoveResult processMove(int row, int col);
+        MoveResult chordCell(int row, int col);
+        bool checkMove(int row, int col) const;
+        MoveResult handleFirstClick(int row, int col);
+        void floodFill(int row, int col);
+        void placeMines(int row, int col);
+        bool checkGameStatus() const;
+        bool stillPlaying() const;
+        bool getWin() const;
+        GameState getState() const;
+        int getRows() const;
+        int getCols() const;
+        // The bombs the board holds once mines are placed, which placeMines lowers when the
+        // first click leaves fewer cells than were asked for.
+        int getBombs() const;
+        // The bombs the board was made with, which is what a new game on it asks for again.
+        int getRequestedBombs() const;
+        int getFlagCount() const;
+        int getUnopenedSafe() const;
+        void setSeed(uint64_t seed);
+        uint64_t getSeed() const;
+        // A hash of every open or flagged cell together with its contents, kept up to date as
+        // cells change. Boards that agree on it show the player the same game.
+        uint64_t getStateHash() const;
+        const Cell& getCell(int row, int col) const;
+        // While set, every cell opened or (un)flagged is appended to `changed` as row * cols + col,
+        // so a frontend can redraw just those. Pass nullptr to stop tracking.
+        void trackChanges(std::vector<int>* changed);
+        // While set, every move records the cells it changed in `history` (which is cleared), so
+        // undo() and redo() can step through the game at a cost proportional to those cells.
+        // Pass nullptr to stop recording.
+        void trackHistory(History* history);
+        // Return false when there is nothing to undo or redo.
+        bool undo();
+        bool redo();
+        bool getMinesPlaced() const;
+    private:
+        // builds boards straight on a mapped snapshot file
+        friend class Snapshot;
+        template<int Rows, int Cols> friend class PresetBoard;
+        // The whole-board loops of a board whose size is fixed at compile time. Null on boards
+        // sized at run time.
+        struct Kernels{
+            void (*fill)(Board& board, int index);
+            void (*calculateValues)(Board& board);
+        };
+        Board(const Board&);
+        Board& operator=(const Board&);
+        int index(int row, int col) const;
+        void openCell(int index);
+        MoveResult moveResult() const;
+        // The cell's row * cols + col, as trackChanges reports it.
+        int cellNumber(int index) const;
+        void markSentinels();
+        // Whether every sentinel is as markSentinels leaves it. Only reads the grid.
+        bool sentinelsIntact() const;
+        // Opens from a cell: a fill from a blank one, just the cell from a number.
+        void fill(int index);
+        // fill written once for both kinds of shape
+        template<class Shape> void fillFrom(Shape shape, int start);
+        template<class Shape> void scanFillRow(Shape shape, int row, int left, int right);
+        static bool canSpread(const Cell& cell);
+        int countUnopenedSafe() const;
+        int candidateCell(int n, const int* excluded, int numExcluded) const;
+        void toggleFlag(int index);
+        void closeCell(int index);
+        enum { FLAG_SHARE = 0x100 };
+        static uint64_t cellHash(int index, unsigned shown);
+        void recordOpened(int index);
+        // The grid is stored with a ring of sentinel cells around the board, which are open and
+        // hold no bomb, so neighbour walks need no bounds checks: counting finds no bomb in them,
+        // and fills and chords skip them as already open. m_cells is the top left sentinel and
+        // m_grid the first real cell, so a cell's index is row * m_stride + col, and its
+        // neighbours are m_neighbours away.
+        Cell* m_cells;
+        Cell* m_grid;
+        int m_stride;
+        int m_neighbours[8];
+        // false when the cells live in memory the board did not allocate, such as a mapped snapshot
+        bool m_ownsGrid;
+        int m_bombs;
+        // the count the board was made with; m_bombs is clamped from it when a first click
+        // leaves too few cells, and goes back to it on reset
+        int m_requestedBombs;
+        int m_rows;
+        int m_cols;
+        int bombsFlagged;
+        int m_unopenedSafe;
+        bool m_minesPlaced;
+        GameState m_state;
+        uint64_t m_seed;
+        uint64_t m_stateHash;
+        std::vector<int> m_fillStack;
+        std::vector<unsigned char> m_countScratch;
+        std::vector<int>* m_changed;
+        History* m_history;
+        const Kernels* m_kernels;
+};
+
+inline Cell::Cell()
+{
+    m_bits = 0;
+}
+
+inline char Cell::getValue() const
+{
+    if(isBomb()) return 'X';
+    if(getCount() > 0) return getCount() + '0';
+    return ' ';
+}
+
+inline int Cell::getCount() const
+{
+    return m_bits & COUNT_MASK;
+}
+
+inline void Cell::setCount(int count)
+{
+    m_bits = (m_bits & ~COUNT_MASK) | count;
+}
+
+inline bool Cell::getFlag() const
+{
+    return m_bits & FLAG_BIT;
+}
+
+inline void Cell::setFlag(bool value)
+{
+    if(value) m_bits |= FLAG_BIT;
+    else m_bits &= ~FLAG_BIT;
+}
+
+inline bool Cell::isBomb() const
+{
+    return m_bits & BOMB_BIT;
+}
+
+inline bool Cell::isOpened() const
+{
+    return m_bits & OPENED_BIT;
+}
+
+inline char Cell::getDisplayValue() const
+{
+    if(isOpened()) return getValue();
+    return 'U';
+}
+
+inline void Cell::setBomb(bool value)
+{
+    if(value) m_bits |= BOMB_BIT;
+    else m_bits &= ~BOMB_BIT;
+}
+
+inline void Cell::openCell()
+{
+    if(getFlag()) return;
+    m_bits |= OPENED_BIT;
+}
+
+inline void Cell::closeCell()
+{
+    m_bits &= ~OPENED_BIT;
+}
+
+inline int Board::index(int row, int col) const
+{
+    return row * m_stride + col;
+}
+
+inline const Cell& Board::getCell(int row, int col) const
+{
+    return m_grid[index(row, col)];
+}
+
+// One cell's share of the state hash: its position and what it shows, mixed so that the XOR
+// of many shares does not cancel out. An open cell shows its raw byte; a flag shows only
+// FLAG_SHARE, since the cell under it is hidden and may not even have its mine placed yet.
+inline uint64_t Board::cellHash(int index, unsigned shown)
+{
+    uint64_t x = (uint64_t(index) << 9 | shown) * 0x9E3779B97F4A7C15ULL;
+    x ^= x >> 32;
+    return x * 0xD6E8FEB86659FD93ULL;
+}
+
+// Inline, since fills call it for every cell they reach.
+inline void Board::openCell(int index)
+{
+    Cell& cell = m_grid[index];
+    if(cell.isOpened() || cell.getFlag()) return;
+    cell.openCell();
+    m_stateHash ^= cellHash(index, *reinterpret_cast<const unsigned char*>(&cell));
+    if(m_changed || m_history) recordOpened(index);
+    if(cell.isBomb()) m_state = GAME_LOST;
+    else if(--m_unopenedSafe == 0 && m_state == GAME_PLAYING) m_state = GAME_WON;
+}
+
+inline bool Board::canSpread(const Cell& cell)
+{
+    return !cell.isOpened() && !cell.getFlag() && cell.getValue() == ' ';
+}
+
+// Scanline fill: each popped seed is widened into a run of blank cells, the run and its
+// border are opened, and one seed is pushed per blank run found in the rows above and below.
+// Every cell is opened at most once and the seed stack stays small even for huge regions. The
+// sentinels end every run and every border is opened unconditionally, since opening a sentinel
+// does nothing.
+template<class Shape>
+void Board::fillFrom(Shape shape, int start)
+{
+    const int stride = shape.cols + 2;
+    if(m_grid[start].isOpened() || m_grid[start].getFlag()) return;
+    if(m_grid[start].getValue() != ' '){
+        openCell(start);
+        return;
+    }
+    STAT_TIME(STAT_FLOOD_FILL);
+#ifdef MINESWEEPER_STATS
+    int unopened = m_unopenedSafe;
+    size_t highWater = 0;
+#endif
+    m_fillStack.clear();
+    m_fillStack.push_back(start);
+    while(!m_fillStack.empty()){
+#ifdef MINESWEEPER_STATS
+        if(m_fillStack.size() > highWater) highWater = m_fillStack.size();
+#endif
+        int seed = m_fillStack.back();
+        m_fillStack.pop_back();
+        if(m_grid[seed].isOpened()) continue;
+        int r = seed / stride;
+        const Cell* line = m_grid + r * stride;
+        int left = seed - r * stride;
+        int right = left;
+        while(canSpread(line[left-1])) left--;
+        while(canSpread(line[right+1])) right++;
+        left--;
+        right++;
+        for(int c = left; c <= right; c++){
+            openCell(r * stride + c);
+        }
+        scanFillRow(shape, r - 1, left, right);
+        scanFillRow(shape, r + 1, left, right);
+    }
+    STAT_RECORD(STAT_FILL_CELLS, unopened - m_unopenedSafe);
+    STAT_RECORD(STAT_FILL_STACK, highWater);
+}
+
+template<class Shape>
+void Board::scanFillRow(Shape shape, int row, int left, int right)
+{
+    const int stride = shape.cols + 2;
+    const Cell* line = m_grid + row * stride;
+    bool inRun = false;
+    for(int c = left; c <= right; c++){
+        if(canSpread(line[c])){
+            if(!inRun) m_fillStack.push_back(row * stride + c);
+            inRun = true;
+        }
+        else{
+            openCell(row * stride + c);
+            inRun = false;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,64 @@
+#include "boardpool.h"
+#include "presetboard.h"
+#include <algorithm>
+#include <chrono>
+using namespace std;
+
+BoardPool::BoardPool(size_t maxIdle)
+{
+    m_maxIdle = maxIdle;
+    m_created = 0;
+}
+
+BoardPool::~BoardPool()
+{
+    for(const Entry& entry : m_idle) delete entry.board;
+    for(const Entry& entry : m_lent) delete entry.board;
+}
+
+Board* BoardPool::acquire(int rows, int cols, int bombs)
+{
+    Board* board = nullptr;
+    // the most recently released match is the likeliest to still be in cache
+    for(size_t i = m_idle.size(); i-- > 0;){
+        const Entry& idle = m_idle[i];
+        if(idle.board->getRows() != rows || idle.board->getCols() != cols || idle.bombs != bombs) continue;
+        board = idle.board;
+        m_idle.erase(m_idle.begin() + i);
+        board->reset();
+        board->setSeed(chrono::high_resolution_clock::now().time_since_epoch().count());
+        break;
+    }
+    if(!board){
+        board = newBoard(rows, cols, bombs);
+        m_created++;
+    }
+    m_lent.push_back(Entry{board, bombs});
+    return board;
+}
+
+void BoardPool::release(Board* board)
+{
+    vector<Entry>::iterator lent = find_if(m_lent.begin(), m_lent.end(), [board](const Entry& entry){ return entry.board == board; });
+    if(lent == m_lent.end()) return;
+    Entry entry = *lent;
+    *lent = m_lent.back();
+    m_lent.pop_back();
+    board->trackChanges(nullptr);
+    board->trackHistory(nullptr);
+    m_idle.push_back(entry);
+    if(m_idle.size() > m_maxIdle){
+        delete m_idle.front().board;
+        m_idle.erase(m_idle.begin());
+    }
+}
+
+size_t BoardPool::getIdleCount() const
+{
+    return m_idle.size();
+}
+
+size_t BoardPool::getCreatedCount() const
+{
+    return m_created;
+}
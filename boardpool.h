@@ -0,0 +1,41 @@
+#ifndef BOARDPOOL_H
+#define BOARDPOOL_H
+
+#include <cstddef>
+#include <vector>
+#include "board.h"
+
+// Boards kept for reuse between games. A board handed back is kept, and the next game of the
+// same rows, cols and bombs gets it back cleared in place with a fresh seed, so playing again
+// costs one memset instead of an allocation. The pool owns every board it hands out and frees
+// them all when it goes, so a board that is never released still does not leak. At most
+// `maxIdle` boards wait for reuse; handing back another frees the one idle the longest.
+// Not thread safe: a thread that plays games keeps its own pool.
+class BoardPool{
+    public:
+        BoardPool(size_t maxIdle = 4);
+        ~BoardPool();
+        // A new game on a board of this size, reused when one is idle. New boards come from
+        // newBoard(), so the standard levels get a PresetBoard.
+        Board* acquire(int rows, int cols, int bombs);
+        // Returns a board from acquire() for reuse, detaching any change or history tracking.
+        void release(Board* board);
+        size_t getIdleCount() const;
+        // Boards allocated so far, reused or not.
+        size_t getCreatedCount() const;
+    private:
+        BoardPool(const BoardPool&);
+        BoardPool& operator=(const BoardPool&);
+        struct Entry{
+            Board* board;
+            // as asked for in acquire(); the board's own count may be clamped by its first click
+            int bombs;
+        };
+        // in the order they were released, oldest first
+        std::vector<Entry> m_idle;
+        std::vector<Entry> m_lent;
+        size_t m_maxIdle;
+        size_t m_created;
+};
+
+#endif
@@ -0,0 +1,279 @@
+#include "endless.h"
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+EndlessBoard::EndlessBoard(uint64_t seed, int bombsPerChunk)
+{
+    m_seed = seed;
+    m_bombsPerChunk = min(max(bombsPerChunk, CHUNK_CELLS * 12 / 100), CHUNK_CELLS - 9);
+    m_opened = 0;
+    m_flags = 0;
+    m_resolved = 0;
+    m_state = GAME_PLAYING;
+    m_lastKey = ChunkKey{0, 0};
+    m_lastChunk = nullptr;
+}
+
+EndlessBoard::~EndlessBoard()
+{
+    for(auto& entry : m_chunks){
+        delete[] entry.second.cells;
+        delete[] entry.second.flags;
+    }
+}
+
+// Chunk coordinates are the cell coordinates shifted down, which floors for negative cells too.
+bool EndlessBoard::ChunkKey::operator==(const ChunkKey& other) const
+{
+    return row == other.row && col == other.col;
+}
+
+size_t EndlessBoard::ChunkKeyHash::operator()(const ChunkKey& key) const
+{
+    uint64_t x = uint64_t(key.row) * 0x9E3779B97F4A7C15ULL ^ uint64_t(key.col);
+    x *= 0xD6E8FEB86659FD93ULL;
+    return x ^ (x >> 32);
+}
+
+// The chunk's low 32 bits of row and column, packed, with whatever lies past them mixed in.
+// Chunks within 2^31 of the origin keep the seeds they had when only the low bits were used.
+static uint64_t chunkSeed(int64_t chunkRow, int64_t chunkCol)
+{
+    uint64_t low = (uint64_t(uint32_t(chunkRow)) << 32) | uint32_t(chunkCol);
+    uint64_t beyond = uint64_t(chunkRow - int32_t(chunkRow)) * 0x9E3779B97F4A7C15ULL ^ uint64_t(chunkCol - int32_t(chunkCol)) * 0xC2B2AE3D27D4EB4FULL;
+    return low * 0xD1B54A32D192ED03ULL ^ beyond;
+}
+
+// Floyd's sample of the chunk's bombs, seeded from the board seed and the chunk coordinates.
+void EndlessBoard::mines(int64_t chunkRow, int64_t chunkCol, uint64_t bits[CHUNK_SIZE]) const
+{
+    memset(bits, 0, CHUNK_SIZE * sizeof(uint64_t));
+    Random rng(m_seed ^ chunkSeed(chunkRow, chunkCol));
+    for(int j = CHUNK_CELLS - m_bombsPerChunk; j < CHUNK_CELLS; j++){
+        int pick = rng.below(j + 1);
+        if(bits[pick >> CHUNK_BITS] >> (pick & (CHUNK_SIZE - 1)) & 1) pick = j;
+        bits[pick >> CHUNK_BITS] |= uint64_t(1) << (pick & (CHUNK_SIZE - 1));
+    }
+    for(int64_t r = -1; r <= 1; r++){
+        for(int64_t c = -1; c <= 1; c++){
+            if((r >> CHUNK_BITS) != chunkRow || (c >> CHUNK_BITS) != chunkCol) continue;
+            bits[r & (CHUNK_SIZE - 1)] &= ~(uint64_t(1) << (c & (CHUNK_SIZE - 1)));
+        }
+    }
+}
+
+// Lays out the chunk's cells with counts. The bombs of the ring of cells around the chunk come
+// from the eight neighbouring chunks, which are regenerated for this rather than stored.
+void EndlessBoard::generate(Chunk& target, int64_t chunkRow, int64_t chunkCol)
+{
+    const int PADDED = CHUNK_SIZE + 2;
+    unsigned char bombs[PADDED * PADDED];
+    uint64_t bits[CHUNK_SIZE];
+    for(int dr = -1; dr <= 1; dr++){
+        for(int dc = -1; dc <= 1; dc++){
+            mines(chunkRow + dr, chunkCol + dc, bits);
+            // the part of that chunk that falls inside the padded frame
+            int firstRow = dr < 0 ? CHUNK_SIZE - 1 : 0, lastRow = dr > 0 ? 0 : CHUNK_SIZE - 1;
+            int firstCol = dc < 0 ? CHUNK_SIZE - 1 : 0, lastCol = dc > 0 ? 0 : CHUNK_SIZE - 1;
+            for(int r = firstRow; r <= lastRow; r++){
+                for(int c = firstCol; c <= lastCol; c++){
+                    int pr = r + 1 + dr * CHUNK_SIZE, pc = c + 1 + dc * CHUNK_SIZE;
+                    bombs[pr * PADDED + pc] = bits[r] >> c & 1;
+                }
+            }
+        }
+    }
+    target.cells = new Cell[CHUNK_CELLS];
+    target.unopenedSafe = 0;
+    for(int r = 0; r < CHUNK_SIZE; r++){
+        for(int c = 0; c < CHUNK_SIZE; c++){
+            const unsigned char* centre = bombs + (r + 1) * PADDED + c + 1;
+            int count = centre[-PADDED - 1] + centre[-PADDED] + centre[-PADDED + 1]
+                      + centre[-1] + centre[1]
+                      + centre[PADDED - 1] + centre[PADDED] + centre[PADDED + 1];
+            Cell& cell = target.cells[r * CHUNK_SIZE + c];
+            cell.setBomb(*centre);
+            cell.setCount(count);
+            if(!*centre) target.unopenedSafe++;
+        }
+    }
+}
+
+// Rebuilds a resolved chunk: every safe cell open, flags where they were.
+void EndlessBoard::expand(Chunk& target, int64_t chunkRow, int64_t chunkCol)
+{
+    generate(target, chunkRow, chunkCol);
+    for(int i = 0; i < CHUNK_CELLS; i++){
+        Cell& cell = target.cells[i];
+        if(!cell.isBomb()) cell.openCell();
+        else if(target.allFlagged || (target.flags && (target.flags[i >> CHUNK_BITS] >> (i & (CHUNK_SIZE - 1)) & 1))) cell.setFlag(true);
+    }
+    target.unopenedSafe = 0;
+    delete[] target.flags;
+    target.flags = nullptr;
+    target.allFlagged = false;
+    m_expanded.push_back(ChunkKey{chunkRow, chunkCol});
+}
+
+void EndlessBoard::compress(Chunk& target)
+{
+    int flagged = 0, bombs = 0;
+    uint64_t flags[CHUNK_SIZE] = {0};
+    for(int i = 0; i < CHUNK_CELLS; i++){
+        bombs += target.cells[i].isBomb();
+        if(!target.cells[i].getFlag()) continue;
+        flags[i >> CHUNK_BITS] |= uint64_t(1) << (i & (CHUNK_SIZE - 1));
+        flagged++;
+    }
+    // only bombs are left closed, and a closed cell is the only kind that can be flagged
+    target.allFlagged = flagged == bombs;
+    if(flagged > 0 && !target.allFlagged){
+        target.flags = new uint64_t[CHUNK_SIZE];
+        memcpy(target.flags, flags, sizeof(flags));
+    }
+    delete[] target.cells;
+    target.cells = nullptr;
+}
+
+void EndlessBoard::compressResolved()
+{
+    for(const ChunkKey& resolved : m_expanded){
+        unordered_map<ChunkKey, Chunk, ChunkKeyHash>::iterator found = m_chunks.find(resolved);
+        if(found != m_chunks.end() && found->second.cells && found->second.unopenedSafe == 0) compress(found->second);
+    }
+    m_expanded.clear();
+}
+
+EndlessBoard::Chunk& EndlessBoard::chunk(int64_t chunkRow, int64_t chunkCol)
+{
+    ChunkKey wanted = {chunkRow, chunkCol};
+    if(m_lastChunk && m_lastKey == wanted) return *m_lastChunk;
+    unordered_map<ChunkKey, Chunk, ChunkKeyHash>::iterator found = m_chunks.find(wanted);
+    if(found == m_chunks.end()){
+        found = m_chunks.emplace(wanted, Chunk{nullptr, nullptr, 0, false}).first;
+        generate(found->second, chunkRow, chunkCol);
+    }
+    m_lastKey = wanted;
+    m_lastChunk = &found->second;
+    return found->second;
+}
+
+Cell& EndlessBoard::cell(int64_t row, int64_t col)
+{
+    Chunk& owner = chunk(row >> CHUNK_BITS, col >> CHUNK_BITS);
+    if(!owner.cells) expand(owner, row >> CHUNK_BITS, col >> CHUNK_BITS);
+    return owner.cells[(row & (CHUNK_SIZE - 1)) * CHUNK_SIZE + (col & (CHUNK_SIZE - 1))];
+}
+
+void EndlessBoard::openCell(int64_t row, int64_t col)
+{
+    Cell& target = cell(row, col);
+    if(target.isOpened() || target.getFlag()) return;
+    target.openCell();
+    m_opened++;
+    if(target.isBomb()){
+        m_state = GAME_LOST;
+        return;
+    }
+    Chunk& owner = chunk(row >> CHUNK_BITS, col >> CHUNK_BITS);
+    if(--owner.unopenedSafe == 0){
+        m_resolved++;
+        m_expanded.push_back(ChunkKey{row >> CHUNK_BITS, col >> CHUNK_BITS});
+    }
+}
+
+// Opens a blank region cell by cell, crossing chunk boundaries freely.
+void EndlessBoard::floodFill(int64_t row, int64_t col)
+{
+    m_fillStack.clear();
+    m_fillStack.push_back(make_pair(row, col));
+    while(!m_fillStack.empty()){
+        pair<int64_t, int64_t> next = m_fillStack.back();
+        m_fillStack.pop_back();
+        const Cell& target = cell(next.first, next.second);
+        if(target.isOpened() || target.getFlag()) continue;
+        openCell(next.first, next.second);
+        if(target.getValue() != ' ') continue;
+        for(int64_t r = next.first - 1; r <= next.first + 1; r++){
+            for(int64_t c = next.second - 1; c <= next.second + 1; c++){
+                if(!cell(r, c).isOpened()) m_fillStack.push_back(make_pair(r, c));
+            }
+        }
+    }
+}
+
+MoveResult EndlessBoard::processMove(int64_t row, int64_t col)
+{
+    if(m_state != GAME_PLAYING) return MOVE_INVALID;
+    const Cell& target = cell(row, col);
+    if(target.isOpened()) return MOVE_ALREADY_OPEN;
+    if(target.getFlag()) return MOVE_FLAGGED;
+    if(target.getValue() == ' ') floodFill(row, col);
+    else openCell(row, col);
+    compressResolved();
+    return m_state == GAME_LOST ? MOVE_BOMB : MOVE_OK;
+}
+
+MoveResult EndlessBoard::flagCell(int64_t row, int64_t col)
+{
+    if(m_state != GAME_PLAYING) return MOVE_INVALID;
+    Cell& target = cell(row, col);
+    if(target.isOpened()) return MOVE_ALREADY_OPEN;
+    target.setFlag(!target.getFlag());
+    m_flags += target.getFlag() ? 1 : -1;
+    compressResolved();
+    return MOVE_OK;
+}
+
+const Cell& EndlessBoard::getCell(int64_t row, int64_t col)
+{
+    return cell(row, col);
+}
+
+bool EndlessBoard::stillPlaying() const
+{
+    return m_state == GAME_PLAYING;
+}
+
+GameState EndlessBoard::getState() const
+{
+    return m_state;
+}
+
+int64_t EndlessBoard::getOpenedCount() const
+{
+    return m_opened;
+}
+
+int64_t EndlessBoard::getFlagCount() const
+{
+    return m_flags;
+}
+
+int EndlessBoard::getBombsPerChunk() const
+{
+    return m_bombsPerChunk;
+}
+
+size_t EndlessBoard::getChunkCount() const
+{
+    return m_chunks.size();
+}
+
+size_t EndlessBoard::getResolvedCount() const
+{
+    return m_resolved;
+}
+
+size_t EndlessBoard::getMemoryUsage() const
+{
+    // a map node holds the key, the chunk and a next pointer, plus one bucket pointer
+    size_t bytes = m_chunks.bucket_count() * sizeof(void*);
+    for(const auto& entry : m_chunks){
+        bytes += sizeof(entry) + sizeof(void*);
+        if(entry.second.cells) bytes += CHUNK_CELLS * sizeof(Cell);
+        if(entry.second.flags) bytes += CHUNK_SIZE * sizeof(uint64_t);
+    }
+    return bytes;
+}
@@ -0,0 +1,82 @@
+#ifndef ENDLESS_H
+#define ENDLESS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "board.h"
+
+// An unbounded board. The plane is split into CHUNK_SIZE x CHUNK_SIZE chunks, and a chunk's
+// mines are a pure function of the seed and its coordinates, so chunks are only created when
+// a cell in them is first touched. Counts on a chunk's edge come from regenerating the
+// neighbouring chunks' mines, without storing those chunks. Once every safe cell of a chunk is
+// open, it is resolved: its cells are dropped and at most its flags are kept, since everything
+// else can be regenerated. Memory therefore follows the explored frontier, not the plane.
+//
+// The 3x3 block around (0, 0) never holds a mine, so a game starts by opening (0, 0). There is
+// no win; the game goes on until a mine is opened.
+class EndlessBoard{
+    public:
+        enum { CHUNK_BITS = 6, CHUNK_SIZE = 1 << CHUNK_BITS, CHUNK_CELLS = CHUNK_SIZE * CHUNK_SIZE };
+        // `bombsPerChunk` is clamped to at least 12% of a chunk. At 9% or less the blank cells
+        // percolate and the first opening never ends, and up to 11% it can still run to tens of
+        // thousands of cells.
+        EndlessBoard(uint64_t seed, int bombsPerChunk);
+        ~EndlessBoard();
+        MoveResult processMove(int64_t row, int64_t col);
+        MoveResult flagCell(int64_t row, int64_t col);
+        // Generates the cell's chunk if needed.
+        const Cell& getCell(int64_t row, int64_t col);
+        bool stillPlaying() const;
+        GameState getState() const;
+        int64_t getOpenedCount() const;
+        int64_t getFlagCount() const;
+        int getBombsPerChunk() const;
+        size_t getChunkCount() const;
+        size_t getResolvedCount() const;
+        // Heap bytes held for chunks, map nodes included.
+        size_t getMemoryUsage() const;
+    private:
+        EndlessBoard(const EndlessBoard&);
+        EndlessBoard& operator=(const EndlessBoard&);
+        struct Chunk{
+            Cell* cells;        // null while resolved
+            uint64_t* flags;    // a resolved chunk's flags, one bit per cell, if only some bombs are flagged
+            int unopenedSafe;
+            bool allFlagged;    // a resolved chunk with every bomb flagged, the usual case, needs no bits
+        };
+        // A chunk's coordinates, whole, so chunks any distance apart never share an entry.
+        struct ChunkKey{
+            int64_t row;
+            int64_t col;
+            bool operator==(const ChunkKey& other) const;
+        };
+        struct ChunkKeyHash{
+            size_t operator()(const ChunkKey& key) const;
+        };
+        Chunk& chunk(int64_t chunkRow, int64_t chunkCol);
+        Cell& cell(int64_t row, int64_t col);
+        void mines(int64_t chunkRow, int64_t chunkCol, uint64_t bits[CHUNK_SIZE]) const;
+        void generate(Chunk& target, int64_t chunkRow, int64_t chunkCol);
+        void expand(Chunk& target, int64_t chunkRow, int64_t chunkCol);
+        void compress(Chunk& target);
+        void openCell(int64_t row, int64_t col);
+        void floodFill(int64_t row, int64_t col);
+        void compressResolved();
+        std::unordered_map<ChunkKey, Chunk, ChunkKeyHash> m_chunks;
+        // resolved chunks currently holding cells, compressed again after each move
+        std::vector<ChunkKey> m_expanded;
+        std::vector<std::pair<int64_t, int64_t>> m_fillStack;
+        uint64_t m_seed;
+        int m_bombsPerChunk;
+        int64_t m_opened;
+        int64_t m_flags;
+        size_t m_resolved;
+        GameState m_state;
+        // the last chunk looked up, since neighbouring cells nearly always share one
+        ChunkKey m_lastKey;
+        Chunk* m_lastChunk;
+};
+
+#endif
@@ -0,0 +1,370 @@
+#include "guiView.h"
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+GlyphAtlas::GlyphAtlas()
+{
+    m_texture = nullptr;
+    m_width = 1;
+    m_height = 1;
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+    clear();
+}
+
+void GlyphAtlas::clear()
+{
+    if(m_texture) SDL_DestroyTexture(m_texture);
+    m_texture = nullptr;
+}
+
+bool GlyphAtlas::build(SDL_Renderer* renderer, TTF_Font* font)
+{
+    // glyphs are laid out in one row, each as wide as its advance
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* glyphs[LAST - FIRST + 1];
+    int width = 0, height = 0;
+    for(int ch = FIRST; ch <= LAST; ch++){
+        SDL_Surface* glyph = TTF_RenderGlyph_Blended(font, ch, white);
+        glyphs[ch - FIRST] = glyph;
+        if(!glyph) continue;
+        m_glyphs[ch - FIRST] = {width, 0, glyph->w, glyph->h};
+        width += glyph->w;
+        height = max(height, glyph->h);
+    }
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, max(width, 1), max(height, 1), 32, SDL_PIXELFORMAT_RGBA32);
+    for(int ch = FIRST; ch <= LAST; ch++){
+        SDL_Surface* glyph = glyphs[ch - FIRST];
+        if(!glyph){
+            m_glyphs[ch - FIRST] = {0, 0, 0, 0};
+            continue;
+        }
+        if(sheet){
+            // copy the alpha as is rather than blending onto the empty sheet
+            SDL_SetSurfaceBlendMode(glyph, SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(glyph, NULL, sheet, &m_glyphs[ch - FIRST]);
+        }
+        SDL_FreeSurface(glyph);
+    }
+    if(!sheet) return false;
+    m_width = sheet->w;
+    m_height = sheet->h;
+    clear();
+    m_texture = SDL_CreateTextureFromSurface(renderer, sheet);
+    SDL_FreeSurface(sheet);
+    if(!m_texture) return false;
+    SDL_SetTextureBlendMode(m_texture, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+void GlyphAtlas::draw(SDL_Renderer* renderer, const char* text, SDL_Color color, int x, int y) const
+{
+    if(!m_texture) return;
+    SDL_SetTextureColorMod(m_texture, color.r, color.g, color.b);
+    for(const char* ch = text; *ch; ch++){
+        if(*ch < FIRST || *ch > LAST) continue;
+        const SDL_Rect& glyph = m_glyphs[*ch - FIRST];
+        SDL_Rect target = {x, y, glyph.w, glyph.h};
+        SDL_RenderCopy(renderer, m_texture, &glyph, &target);
+        x += glyph.w;
+    }
+}
+
+void GlyphAtlas::queue(char ch, SDL_Color color, float x, float y, float scale)
+{
+    if(ch < FIRST || ch > LAST) return;
+    const SDL_Rect& glyph = m_glyphs[ch - FIRST];
+    float left = float(glyph.x) / m_width, right = float(glyph.x + glyph.w) / m_width;
+    float top = float(glyph.y) / m_height, bottom = float(glyph.y + glyph.h) / m_height;
+    float w = glyph.w * scale, h = glyph.h * scale;
+    int first = m_vertices.size();
+    m_vertices.push_back({{x, y}, color, {left, top}});
+    m_vertices.push_back({{x + w, y}, color, {right, top}});
+    m_vertices.push_back({{x + w, y + h}, color, {right, bottom}});
+    m_vertices.push_back({{x, y + h}, color, {left, bottom}});
+    const int corners[6] = {0, 1, 2, 0, 2, 3};
+    for(int corner : corners){
+        m_indices.push_back(first + corner);
+    }
+}
+
+void GlyphAtlas::flush(SDL_Renderer* renderer)
+{
+    if(m_texture && !m_indices.empty()){
+        // the vertex colours tint the glyphs, so the texture's own colour mod must be neutral
+        SDL_SetTextureColorMod(m_texture, 255, 255, 255);
+        SDL_RenderGeometry(renderer, m_texture, m_vertices.data(), m_vertices.size(), m_indices.data(), m_indices.size());
+    }
+    m_vertices.clear();
+    m_indices.clear();
+}
+
+// The original layout: 53 pixel cells, numbers drawn 7 pixels in from the corner.
+const float CELL_SIZE = 53;
+const float TEXT_INSET = 7;
+const float MIN_CELL_SIZE = 2;
+const float MAX_CELL_SIZE = 2 * CELL_SIZE;
+// below these sizes cell borders and numbers would only be noise
+const float BORDER_CELL_SIZE = 6;
+const float TEXT_CELL_SIZE = 12;
+
+Camera::Camera(SDL_Rect viewport, int rows, int cols)
+{
+    m_viewport = viewport;
+    m_rows = rows;
+    m_cols = cols;
+    float fit = min(float(viewport.w) / cols, float(viewport.h) / rows);
+    m_cellSize = min(max(fit, MIN_CELL_SIZE), CELL_SIZE);
+    m_x = 0;
+    m_y = 0;
+    clamp();
+}
+
+void Camera::clamp()
+{
+    float width = m_cols * m_cellSize, height = m_rows * m_cellSize;
+    if(width <= m_viewport.w) m_x = (width - m_viewport.w) / 2;
+    else m_x = min(max(m_x, 0.0f), width - m_viewport.w);
+    if(height <= m_viewport.h) m_y = (height - m_viewport.h) / 2;
+    else m_y = min(max(m_y, 0.0f), height - m_viewport.h);
+}
+
+void Camera::pan(float dx, float dy)
+{
+    m_x += dx;
+    m_y += dy;
+    clamp();
+}
+
+void Camera::zoom(float factor, int x, int y)
+{
+    float size = min(max(m_cellSize * factor, MIN_CELL_SIZE), MAX_CELL_SIZE);
+    float col = (m_x + x - m_viewport.x) / m_cellSize;
+    float row = (m_y + y - m_viewport.y) / m_cellSize;
+    m_cellSize = size;
+    m_x = col * size - (x - m_viewport.x);
+    m_y = row * size - (y - m_viewport.y);
+    clamp();
+}
+
+bool Camera::cellAt(int x, int y, int& row, int& col) const
+{
+    if(x < m_viewport.x || x >= m_viewport.x + m_viewport.w || y < m_viewport.y || y >= m_viewport.y + m_viewport.h) return false;
+    // the inverse of cellRect's rounding: pixel p lies in cell n when floor(n * size - offset) <= p
+    col = int(ceilf((x - m_viewport.x + 1 + m_x) / m_cellSize)) - 1;
+    row = int(ceilf((y - m_viewport.y + 1 + m_y) / m_cellSize)) - 1;
+    return row >= 0 && row < m_rows && col >= 0 && col < m_cols;
+}
+
+void Camera::visibleCells(int& firstRow, int& lastRow, int& firstCol, int& lastCol) const
+{
+    firstCol = max(0, int(floorf(m_x / m_cellSize)));
+    lastCol = min(m_cols, int(ceilf((m_x + m_viewport.w) / m_cellSize)));
+    firstRow = max(0, int(floorf(m_y / m_cellSize)));
+    lastRow = min(m_rows, int(ceilf((m_y + m_viewport.h) / m_cellSize)));
+}
+
+bool Camera::isVisible(int row, int col) const
+{
+    int firstRow, lastRow, firstCol, lastCol;
+    visibleCells(firstRow, lastRow, firstCol, lastCol);
+    return row >= firstRow && row < lastRow && col >= firstCol && col < lastCol;
+}
+
+SDL_Rect Camera::cellRect(int row, int col) const
+{
+    int left = int(floorf(col * m_cellSize - m_x)), right = int(floorf((col + 1) * m_cellSize - m_x));
+    int top = int(floorf(row * m_cellSize - m_y)), bottom = int(floorf((row + 1) * m_cellSize - m_y));
+    return SDL_Rect{m_viewport.x + left, m_viewport.y + top, right - left, bottom - top};
+}
+
+float Camera::getCellSize() const
+{
+    return m_cellSize;
+}
+
+const SDL_Rect& Camera::getViewport() const
+{
+    return m_viewport;
+}
+
+void renderText(SDL_Renderer* renderer, const GlyphAtlas& atlas, const string& text, SDL_Color color, int x, int y){
+    atlas.draw(renderer, text.c_str(), color, x, y);
+}
+
+void drawBoxWithBorder(SDL_Renderer* renderer, SDL_Rect rect, SDL_Color fillColor, SDL_Color borderColor) {
+    SDL_SetRenderDrawColor(renderer, fillColor.r, fillColor.g, fillColor.b, fillColor.a);
+    SDL_RenderFillRect(renderer, &rect);
+
+    SDL_SetRenderDrawColor(renderer, borderColor.r, borderColor.g, borderColor.b, borderColor.a);
+    SDL_RenderDrawRect(renderer, &rect);
+}
+
+void drawBackground(SDL_Renderer* renderer, const Camera& camera){
+   SDL_RenderClear(renderer);
+   SDL_Rect outerBox;
+   outerBox.x = 50;
+   outerBox.y = 50;
+   outerBox.w = 570;
+   outerBox.h = 650;
+   SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+   SDL_RenderDrawRect(renderer, &outerBox);
+   
+   SDL_Rect innerBox;
+   innerBox.x = 70;
+   innerBox.y = 70;
+   innerBox.w = 530;
+   innerBox.h = 60;
+   SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+   SDL_RenderDrawRect(renderer, &innerBox);
+
+    SDL_Rect gameplayBox = camera.getViewport();
+    SDL_RenderDrawRect(renderer, &gameplayBox);
+
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_Rect smileBox;
+    smileBox.x = 315;
+    smileBox.y = 80;
+    smileBox.w = 40;
+    smileBox.h = 40;
+    SDL_RenderDrawRect(renderer, &smileBox);
+
+    SDL_Rect eyeBox;
+    eyeBox.x = 323;
+    eyeBox.y = 88;
+    eyeBox.w = 8;
+    eyeBox.h = 8;
+    SDL_RenderFillRect(renderer, &eyeBox);
+
+    SDL_Rect eyeBox2;
+    eyeBox2.x = 338;
+    eyeBox2.y = 88;
+    eyeBox2.w = 8;
+    eyeBox2.h = 8;
+    SDL_RenderFillRect(renderer, &eyeBox2);
+
+    SDL_RenderDrawLine(renderer, 323, 105, 335, 115);
+    SDL_RenderDrawLine(renderer, 335, 115, 347, 105);
+
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+    SDL_Rect flagBox;
+    flagBox.x = 100;
+    flagBox.y = 80;
+    flagBox.w = 120;
+    flagBox.h = 40;
+    SDL_RenderDrawRect(renderer, &flagBox);
+
+    SDL_Rect timerBox;
+    timerBox.x = 450;
+    timerBox.y = 80;
+    timerBox.w = 120;
+    timerBox.h = 40;
+    SDL_RenderDrawRect(renderer, &timerBox);
+
+
+
+}
+
+void displayBoard(SDL_Renderer* rend, GlyphAtlas& atlas, const Board& board, const Camera& camera){
+    SDL_RenderClear(rend);
+    drawBackground(rend, camera);
+    drawFlagCount(rend, atlas, board);
+    drawBoardView(rend, atlas, board, camera);
+}
+
+enum { FILL_FLAGGED, FILL_OPENED, FILL_CLOSED, FILL_KINDS };
+static const SDL_Color fillColors[FILL_KINDS] = {{255, 255, 255, 0}, {255, 0, 255, 0}, {0, 0, 255, 0}};
+// reused between frames so drawing the view does not allocate
+static vector<SDL_Rect> fills[FILL_KINDS];
+
+static int fillKind(const Cell& cell)
+{
+    if(cell.getFlag()) return FILL_FLAGGED;
+    if(cell.isOpened()) return FILL_OPENED;
+    return FILL_CLOSED;
+}
+
+int drawBoardView(SDL_Renderer* rend, GlyphAtlas& atlas, const Board& board, const Camera& camera){
+    const SDL_Rect& viewport = camera.getViewport();
+    SDL_RenderSetClipRect(rend, &viewport);
+    SDL_SetRenderDrawColor(rend, 0, 0, 0, 255);
+    SDL_RenderFillRect(rend, &viewport);
+
+    float size = camera.getCellSize();
+    float scale = size / CELL_SIZE;
+    bool text = size >= TEXT_CELL_SIZE;
+    SDL_Color color = {255,255,255,255};
+    int firstRow, lastRow, firstCol, lastCol;
+    camera.visibleCells(firstRow, lastRow, firstCol, lastCol);
+    for(int i = firstRow; i < lastRow; i++){
+        for(int j = firstCol; j < lastCol; j++){
+            const Cell& cell = board.getCell(i, j);
+            SDL_Rect box = camera.cellRect(i, j);
+            fills[fillKind(cell)].push_back(box);
+            if(text && cell.isOpened() && cell.getValue() != ' '){
+                atlas.queue(cell.getValue(), color, box.x + TEXT_INSET * scale, box.y + TEXT_INSET * scale, scale);
+            }
+        }
+    }
+    for(int kind = 0; kind < FILL_KINDS; kind++){
+        const SDL_Color& fill = fillColors[kind];
+        SDL_SetRenderDrawColor(rend, fill.r, fill.g, fill.b, fill.a);
+        SDL_RenderFillRects(rend, fills[kind].data(), fills[kind].size());
+    }
+    if(size >= BORDER_CELL_SIZE){
+        SDL_SetRenderDrawColor(rend, 255, 255, 255, 0);
+        for(int kind = 0; kind < FILL_KINDS; kind++){
+            SDL_RenderDrawRects(rend, fills[kind].data(), fills[kind].size());
+        }
+    }
+    for(int kind = 0; kind < FILL_KINDS; kind++){
+        fills[kind].clear();
+    }
+    atlas.flush(rend);
+
+    SDL_RenderSetClipRect(rend, NULL);
+    SDL_SetRenderDrawColor(rend, 255, 255, 255, 255);
+    SDL_RenderDrawRect(rend, &viewport);
+    return (lastRow - firstRow) * (lastCol - firstCol);
+}
+
+void drawCell(SDL_Renderer* rend, GlyphAtlas& atlas, const Board& board, const Camera& camera, int i, int j){
+    if(!camera.isVisible(i, j)) return;
+    SDL_Color b = {255,255,255,0};
+    SDL_Color color = {255,255,255,255};
+    const Cell& cell = board.getCell(i, j);
+    SDL_Rect box = camera.cellRect(i, j);
+    float size = camera.getCellSize();
+    float scale = size / CELL_SIZE;
+    SDL_RenderSetClipRect(rend, &camera.getViewport());
+    if(size >= BORDER_CELL_SIZE) drawBoxWithBorder(rend, box, fillColors[fillKind(cell)], b);
+    else drawBoxWithBorder(rend, box, fillColors[fillKind(cell)], fillColors[fillKind(cell)]);
+    if(size >= TEXT_CELL_SIZE && cell.isOpened() && cell.getValue() != ' '){
+        atlas.queue(cell.getValue(), color, box.x + TEXT_INSET * scale, box.y + TEXT_INSET * scale, scale);
+        atlas.flush(rend);
+    }
+    SDL_RenderSetClipRect(rend, NULL);
+}
+
+// The HUD widgets blank their box's inside before drawing, so they can be redrawn on their own.
+void drawFlagCount(SDL_Renderer* rend, const GlyphAtlas& atlas, const Board& board){
+    SDL_Rect inside = {101, 81, 118, 38};
+    SDL_SetRenderDrawColor(rend, 0, 0, 0, 255);
+    SDL_RenderFillRect(rend, &inside);
+    SDL_Color color = {255,255,255,0};
+    string text = to_string(board.getFlagCount());
+    int buffer = 0;
+    if(board.getFlagCount() > 9) buffer = 8;
+    renderText(rend, atlas, text, color, 155 - buffer, 88);
+}
+
+void drawTimer(SDL_Renderer* rend, const GlyphAtlas& atlas, int seconds){
+    SDL_Rect inside = {451, 81, 118, 38};
+    SDL_SetRenderDrawColor(rend, 0, 0, 0, 255);
+    SDL_RenderFillRect(rend, &inside);
+    SDL_Color color = {255,255,255,255};
+    renderText(rend, atlas, to_string(seconds), color, 505, 88);
+}
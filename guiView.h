@@ -0,0 +1,78 @@
+#ifndef GUIVIEW_H
+#define GUIVIEW_H
+
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include "board.h"
+
+// Every printable ASCII character rasterised once into a single texture. Text is drawn as
+// sub-rect copies tinted with a colour mod, so drawing text creates no surfaces or textures.
+class GlyphAtlas{
+    public:
+        GlyphAtlas();
+        ~GlyphAtlas();
+        // Rasterises the glyphs for `renderer`. Returns false if SDL_ttf or the texture fails.
+        bool build(SDL_Renderer* renderer, TTF_Font* font);
+        // Frees the texture; must run before its renderer is destroyed.
+        void clear();
+        void draw(SDL_Renderer* renderer, const char* text, SDL_Color color, int x, int y) const;
+        // Adds a glyph, scaled by `scale`, to the batch that flush() draws in one
+        // SDL_RenderGeometry call.
+        void queue(char ch, SDL_Color color, float x, float y, float scale);
+        void flush(SDL_Renderer* renderer);
+    private:
+        GlyphAtlas(const GlyphAtlas&);
+        GlyphAtlas& operator=(const GlyphAtlas&);
+        enum { FIRST = 32, LAST = 126 };
+        SDL_Texture* m_texture;
+        SDL_Rect m_glyphs[LAST - FIRST + 1];
+        int m_width;
+        int m_height;
+        std::vector<SDL_Vertex> m_vertices;
+        std::vector<int> m_indices;
+};
+
+// Maps board cells to screen pixels inside a viewport, for boards of any size. The view can be
+// panned and zoomed; when the board is smaller than the viewport it is centred.
+class Camera{
+    public:
+        Camera(SDL_Rect viewport, int rows, int cols);
+        void pan(float dx, float dy);
+        // Scales the cells by `factor` around the screen point (x, y), which stays put.
+        void zoom(float factor, int x, int y);
+        bool cellAt(int x, int y, int& row, int& col) const;
+        // Cells at least partly on screen: rows [firstRow, lastRow), cols [firstCol, lastCol).
+        void visibleCells(int& firstRow, int& lastRow, int& firstCol, int& lastCol) const;
+        bool isVisible(int row, int col) const;
+        // Neighbouring cells get rects that meet exactly, whatever the zoom.
+        SDL_Rect cellRect(int row, int col) const;
+        float getCellSize() const;
+        const SDL_Rect& getViewport() const;
+    private:
+        void clamp();
+        SDL_Rect m_viewport;
+        int m_rows;
+        int m_cols;
+        float m_cellSize;
+        // board pixel shown at the viewport's top-left corner
+        float m_x;
+        float m_y;
+};
+
+// SDL drawing for the GUI frontend. Draws into whatever the renderer targets, so it works the
+// same on a window and offscreen.
+void renderText(SDL_Renderer* renderer, const GlyphAtlas& atlas, const std::string& text, SDL_Color color, int x, int y);
+void drawBoxWithBorder(SDL_Renderer* renderer, SDL_Rect rect, SDL_Color fillColor, SDL_Color borderColor);
+void drawBackground(SDL_Renderer* renderer, const Camera& camera);
+// Redraws everything but the timer.
+void displayBoard(SDL_Renderer* rend, GlyphAtlas& atlas, const Board& board, const Camera& camera);
+// Redraws the cells in view, batched into one fill and one border call per colour plus one
+// geometry call for the numbers. Returns how many cells were drawn.
+int drawBoardView(SDL_Renderer* rend, GlyphAtlas& atlas, const Board& board, const Camera& camera);
+void drawCell(SDL_Renderer* rend, GlyphAtlas& atlas, const Board& board, const Camera& camera, int i, int j);
+void drawFlagCount(SDL_Renderer* rend, const GlyphAtlas& atlas, const Board& board);
+void drawTimer(SDL_Renderer* rend, const GlyphAtlas& atlas, int seconds);
+
+#endif
@@ -0,0 +1,57 @@
+#include "history.h"
+using namespace std;
+
+History::History()
+{
+    m_current = 0;
+    m_end = 0;
+}
+
+History::~History()
+{
+    for(int* block : m_blocks){
+        delete[] block;
+    }
+}
+
+void History::clear()
+{
+    m_entries.clear();
+    m_current = 0;
+    m_end = 0;
+}
+
+bool History::canUndo() const
+{
+    return m_current > 0;
+}
+
+bool History::canRedo() const
+{
+    return m_current < m_entries.size();
+}
+
+size_t History::getEntryCount() const
+{
+    return m_current;
+}
+
+size_t History::getMemoryUsage() const
+{
+    return m_blocks.size() * BLOCK_CELLS * sizeof(int) + m_entries.capacity() * sizeof(Entry);
+}
+
+void History::begin(Kind kind, int cell, GameState before)
+{
+    if(m_current < m_entries.size()){
+        m_end = m_entries[m_current].begin;
+        m_entries.resize(m_current);
+    }
+    m_entries.push_back(Entry{kind, cell, before, m_end});
+    m_current++;
+}
+
+size_t History::end(size_t entry) const
+{
+    return entry + 1 < m_entries.size() ? m_entries[entry + 1].begin : m_end;
+}
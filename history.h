@@ -0,0 +1,61 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <cstddef>
+#include <vector>
+#include "board.h"
+
+// Undo history for a Board (see Board::trackHistory). A move is an entry listing the cells it
+// changed, and nothing else: opening only sets a cell's opened bit and flagging only toggles
+// its flag, so the cell index says how to reverse it. The indices of every entry lie end to end
+// in fixed-size blocks that are kept when entries are dropped, so a move costs one int per
+// changed cell, recording never copies earlier entries, and a warm history does not allocate.
+class History{
+    public:
+        History();
+        ~History();
+        // Drops every entry, keeping the blocks.
+        void clear();
+        bool canUndo() const;
+        bool canRedo() const;
+        // Entries that can be undone.
+        size_t getEntryCount() const;
+        // Bytes held in blocks and entries.
+        size_t getMemoryUsage() const;
+    private:
+        friend class Board;
+        enum Kind{ FIRST_CLICK, OPEN, FLAG };
+        enum { BLOCK_BITS = 12, BLOCK_CELLS = 1 << BLOCK_BITS };
+        struct Entry{
+            Kind kind;
+            int cell;           // the cell the move was made on
+            GameState before;
+            size_t begin;       // where its changed cells start; they end where the next entry's begin
+        };
+        History(const History&);
+        History& operator=(const History&);
+        // Starts recording a move, dropping any undone entries after the current one.
+        void begin(Kind kind, int cell, GameState before);
+        void push(int index);
+        int at(size_t position) const;
+        size_t end(size_t entry) const;
+        std::vector<int*> m_blocks;
+        std::vector<Entry> m_entries;
+        // entries before m_current are done, the ones from it on were undone
+        size_t m_current;
+        size_t m_end;           // where the next changed cell goes
+};
+
+inline void History::push(int index)
+{
+    if((m_end >> BLOCK_BITS) == m_blocks.size()) m_blocks.push_back(new int[BLOCK_CELLS]);
+    m_blocks[m_end >> BLOCK_BITS][m_end & (BLOCK_CELLS - 1)] = index;
+    m_end++;
+}
+
+inline int History::at(size_t position) const
+{
+    return m_blocks[position >> BLOCK_BITS][position & (BLOCK_CELLS - 1)];
+}
+
+#endif
@@ -1,8 +1,18 @@
 #include <iostream>
 #include <string>
 #include <cstdlib>
-#include <cmath>
-#include <ctime>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include "board.h"
+#include "boardpool.h"
+#include "endless.h"
+#include "noguess.h"
+#include "movelog.h"
+#include "history.h"
+#include "stats.h"
+#include "terminalBatch.h"
+#include "terminalView.h"
 using namespace std;
 
 #define bold "\033[1m"
@@ -16,351 +26,165 @@ using namespace std;
 #define colorSeven "\033[30m"      
 #define colorEight "\033[90m"      
 
-class Cell;
-class Board;
 class Game;
 
-class Cell{
-    public:
-        Cell();
-        char getValue() const;
-        void setValue(char value);
-        bool getFlag() const;
-        void setFlag(bool value);
-        char getDisplayValue();
-        void setDisplayValue(char value);
-        void setBomb(bool value);
-        void setBoard(Board* board);
-        bool isBomb() const;
-        bool isOpened() const;
-        void openCell();
-    private: 
-        Board* m_board;
-        char m_value;
-        char m_display_value;
-        bool m_opened;
-        bool m_flagged;
-        bool m_bomb;
-};
-
-class Board{
-    public:
-        Board(Game* game, int rows, int cols, int bombs);
-        ~Board();
-        void calculateValue(int row, int col);
-        void bombOpened();
-        void displayBoard();
-        void flagCell(int row, int col);
-        void processMove(int row, int col);
-        bool checkMove(int row, int col);
-        void handleFirstClick(int row, int col);
-        void floodFill(int row, int col);
-        bool checkGameStatus();
-        bool isNeighbor(int r1, int c1, int r2, int c2);
-        void printValue(char value);
-    private: 
-        Game* m_game;
-        Cell** m_grid;
-        int m_bombs;
-        int m_rows;
-        int m_cols;
-        int bombsFlagged;
-};
+static void playEndless(int bombsPerChunk);
 
 class Game{
    public:
-        Game();
+        Game(BoardPool* boards, NoGuessPool* pool, MoveLogWriter* log);
+        ~Game();
         void endGame(bool won);
         bool getGameVal();
         void play();
         void quit();
+        void displayBoard();
+        void showMove(MoveResult result);
+        void reportMove(MoveResult result);
     private: 
         Board* m_board;
+        BoardPool* m_boards;
+        NoGuessPool* m_pool;
+        MoveLogWriter* m_log;
+        History m_history;
+        TerminalRenderer m_renderer;
         bool m_gameOver;
 };
 
-int main(){
-    cout << bold << "\nWelcome to Minesweeper!" << reset << endl << "-----------------------" << endl;
-    cout << "(Type 100 100 to quit whenever you want)\n" << endl;
-    Game g;
-    g.play();
-    string ans;
-    while(true){
-        cout << "Play Again (y or n): ";
-        cin >> ans;
-        if(ans == "y" || ans == "Y"){
-            Game g;
-            g.play();
-        }
-        else{
-            break;
-        }
-    }
-    cout << "Thanks for playing!";
-}
-
-Cell::Cell()
-{
-    m_display_value = 'U';
-    m_bomb = false;
-    if(m_bomb) m_value = 'X';
-    else m_value = ' ';
-    m_opened = false;
-    m_flagged = false;
-    m_board = nullptr;
-}
-
-char Cell::getValue() const
-{
-    return m_value;
-}
-
-void Cell::setValue(char value)
-{
-    m_value = value;
-}
-
-bool Cell::getFlag() const
-{
-    return m_flagged;
-}
-
-void Cell::setFlag(bool value)
-{
-    m_flagged = value;
-}
-
-bool Cell::isBomb() const
-{
-    return m_bomb;
-}
-
-void Cell::setBoard(Board *board)
-{
-    m_board = board;
-}
-
-bool Cell::isOpened() const
-{
-    return m_opened;
-}
-
-char Cell::getDisplayValue()
-{
-    return m_display_value;
-}
-
-void Cell::setDisplayValue(char value)
-{
-    m_display_value = value;
-}
-
-void Cell::setBomb(bool value)
-{
-    m_bomb = value;
-}
-
-void Cell::openCell()
-{
-    if(m_flagged) return;
-    m_opened = true;
-    if(isBomb()){
-        m_board->bombOpened();
-    }
-    else{
-        setDisplayValue(m_value);
-    }
-}
-
-Board::Board(Game* game, int rows, int cols, int bombs)
-{
-    m_bombs = bombs;
-    m_game = game;
-    m_rows = rows;
-    m_cols = cols;
-    m_grid = new Cell*[rows];
-    for(int i = 0; i < rows; i++){
-        m_grid[i] = new Cell[cols];
-    }
-    bombsFlagged = 0;
-}
-
-Board::~Board()
-{
-    for(int i = 0; i < m_rows; i++){
-        delete[] m_grid[i];
-    }
-    delete[] m_grid;
-}
-
-void Board::calculateValue(int row, int col)
-{
-    int valueCounter = 0;
-    if(col + 1 < m_cols && m_grid[row][col+1].isBomb()) valueCounter++;
-    if(row + 1 < m_rows && m_grid[row+1][col].isBomb()) valueCounter++;
-    if(row + 1 < m_rows && col + 1 < m_cols && m_grid[row+1][col+1].isBomb()) valueCounter++;
-    if(row > 0 && m_grid[row-1][col].isBomb()) valueCounter++;
-    if(col > 0 && m_grid[row][col-1].isBomb()) valueCounter++;
-    if(row > 0 && col > 0 && m_grid[row-1][col-1].isBomb()) valueCounter++;
-    if(row > 0 && col + 1 < m_cols && m_grid[row-1][col+1].isBomb()) valueCounter++;
-    if(col > 0 && row + 1 < m_rows && m_grid[row+1][col-1].isBomb()) valueCounter++;
-    if (m_grid[row][col].isBomb()) m_grid[row][col].setValue('X');
-    else if(valueCounter > 0) m_grid[row][col].setValue(valueCounter + '0');
-    else m_grid[row][col].setValue(' ');
-}
-
-void Board::bombOpened()
-{
-    m_game->endGame(false);
-}
-
-void Board::displayBoard()
-{
-    cout << "-----------------------" << endl << "     ";
-    for(int i = -1; i < m_rows; i++){
-        if(i > 9) cout << i << " | ";
-        else if(i != -1) cout << i << "  | ";
-        for(int j = 0; j < m_cols; j++){
-            if(i == -1){
-                if(j > 9) cout << j << " ";
-                else cout << j << "  ";
+int main(int argc, char* argv[]){
+    // --no-guess deals only boards that can be cleared by deduction from the first click,
+    // --record writes every game's moves to a move log for the replay tool, and --batch plays
+    // a move stream from a file or stdin without prompts (see terminalBatch.h). --endless plays
+    // an unbounded board, optionally with the bombs per 64x64 chunk. Built with
+    // -DMINESWEEPER_STATS, the hot-path stats (see stats.h) are written on exit.
+    bool noGuess = false, batch = false, show = false, endless = false;
+    const char* batchPath = nullptr;
+    int every = 0;
+    int bombsPerChunk = EndlessBoard::CHUNK_CELLS * 15 / 100;
+    MoveLogWriter log;
+    for(int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if(arg == "--no-guess") noGuess = true;
+        else if(arg == "--record" && i + 1 < argc){
+            if(!log.open(argv[++i])){
+                cerr << log.getError() << endl;
+                return EXIT_FAILURE;
             }
-            else if(!m_game->getGameVal()){
-                if(m_grid[i][j].getFlag()) cout << colorThree << "F" << reset << "  ";
-                else printValue(m_grid[i][j].getDisplayValue()); 
-            }
-            else printValue(m_grid[i][j].getValue());
-        }
-        cout << "\n";
-    }
-    cout << "\n" << "Bombs Flagged: " << bombsFlagged << " / " << m_bombs << endl;
-    cout << "-----------------------" << endl;
-}
-
-void Board::printValue(char value){
-    if(value == 'U') cout << colorEight << value << reset << "  ";
-    else if(value == 'X') cout << colorFive << value << reset << "  ";
-    else if(value == 'F') cout << colorThree << value << reset <<  "  ";
-    else if(value == '1') cout << colorOne << value << reset << "  "; 
-    else if(value == '2') cout << colorTwo << value << reset << "  ";
-    else if(value == '3') cout << colorThree << value << reset << "  ";    
-    else if(value == '4') cout << colorFour << value << reset << "  ";
-    else if(value == '5') cout << colorFive << value << reset << "  ";
-    else if(value == '6') cout << colorSix << value << reset << "  ";
-    else if(value == '7') cout << colorSeven << value << reset << "  ";
-    else if(value == '8') cout << colorEight << value << reset << "  ";
-    else cout << value << "  ";
-}
-
-void Board::flagCell(int row, int col)
-{
-    if(!m_grid[row][col].isOpened()) {
-        if(m_grid[row][col].getFlag()){
-            m_grid[row][col].setFlag(false);
-            bombsFlagged--;
         }
-        else{
-            m_grid[row][col].setFlag(true);
-            bombsFlagged++;
+        else if(arg == "--batch"){
+            batch = true;
+            if(i + 1 < argc && argv[i + 1][0] != '-') batchPath = argv[++i];
         }
-    }
-    else cout << "Don't flag this. It's already open!" << endl;
-}
-
-void Board::processMove(int row, int col)
-{
-    if(checkMove(row, col)){
-        if(m_grid[row][col].getFlag()) cout << "You can't open this. It is flagged!" << endl;
-        else if(m_grid[row][col].getValue() == ' ') floodFill(row, col);
-        else m_grid[row][col].openCell();
-    }
-    else{
-        cout << "Invalid Move" << endl;
-    }
-}
-
-bool Board::checkMove(int row, int col){
-    return (row >= 0 && row < m_rows && col >= 0 && col < m_cols && !m_grid[row][col].isOpened());
-}
-
-void Board::handleFirstClick(int row, int col){
-    int r = 0;
-    int c = 0;
-    srand(time(0));
-    while(!checkMove(row, col)){
-        cout << "Not the right format (row number, space, then column number)" << endl;
-        cout << "Try again: ";
-        cin >> row >> col;
-    }
-
-    bool** bombMatrix;
-    bombMatrix = new bool*[m_rows];
-    for(int i = 0; i < m_rows; i++){
-        bombMatrix[i] = new bool[m_cols]();
-    }
-    for(int i = 0; i < m_bombs; i++){
-        r = rand() % m_rows;
-        c = rand() % m_cols;
-        while(isNeighbor(r,c,row,col) || bombMatrix[r][c]){
-            r = rand() % m_rows;
-            c = rand() % m_cols;
+        else if(arg == "--every" && i + 1 < argc) every = atoi(argv[++i]);
+        else if(arg == "--show") show = true;
+        else if(arg == "--endless"){
+            endless = true;
+            if(i + 1 < argc && argv[i + 1][0] != '-') bombsPerChunk = atoi(argv[++i]);
         }
-        bombMatrix[r][c] = true;
-    }
-
-    for(int i = 0; i < m_rows; i++){
-        for(int j = 0; j < m_cols; j++){
-            m_grid[i][j].setBomb(bombMatrix[i][j]);
-            m_grid[i][j].setBoard(this);
+        else{
+            cerr << "usage: minesweeper [--no-guess] [--record log] [--batch [moves] [--every n] [--show]] [--endless [bombsPerChunk]]" << endl;
+            return EXIT_FAILURE;
         }
     }
-    for(int i = 0; i < m_rows; i++){
-        for(int j = 0; j < m_cols; j++){
-            calculateValue(i, j);
+    if(batch){
+        int fd = batchPath ? open(batchPath, O_RDONLY) : 0;
+        if(fd < 0){
+            cerr << "cannot open " << batchPath << endl;
+            return EXIT_FAILURE;
         }
+        bool played = runBatch(fd, every, show, log);
+        if(batchPath) close(fd);
+        if(STATS_ENABLED && !writeStats(statsPath())) cerr << "cannot write " << statsPath() << endl;
+        return played ? EXIT_SUCCESS : EXIT_FAILURE;
     }
-    floodFill(row, col);
-
-    for (int i = 0; i < m_rows; i++) {
-        delete[] bombMatrix[i];
+    if(endless){
+        playEndless(bombsPerChunk);
+        if(STATS_ENABLED && !writeStats(statsPath())) cerr << "cannot write " << statsPath() << endl;
+        return EXIT_SUCCESS;
     }
-    delete[] bombMatrix;
-}
-
-void Board::floodFill(int row, int col)
-{
-    if(row < 0 || col < 0 || row >= m_rows || col >= m_cols || m_grid[row][col].isOpened() ||  m_grid[row][col].getFlag()) return;
-    m_grid[row][col].openCell();
-    if(m_grid[row][col].getValue() != ' ') return;
-    floodFill(row+1,col);
-    floodFill(row,col+1);
-    floodFill(row+1,col+1);
-    floodFill(row-1,col-1);   
-    floodFill(row,col-1); 
-    floodFill(row-1,col); 
-    floodFill(row-1,col+1);
-    floodFill(row+1,col-1); 
+    // every round of Play Again reuses the board of the last round on that level
+    BoardPool boards;
+    NoGuessPool* pool = nullptr;
+    if(noGuess) pool = new NoGuessPool(thread::hardware_concurrency(), 4, chrono::steady_clock::now().time_since_epoch().count());
+    cout << bold << "\nWelcome to Minesweeper!" << reset << endl << "-----------------------" << endl;
+    cout << "(Type 100 100 to quit whenever you want)\n" << endl;
+    string ans;
+    do{
+        // the game hands its board back to the pool before the next round starts
+        Game g(&boards, pool, &log);
+        g.play();
+        cout << "Play Again (y or n): ";
+        cin >> ans;
+    }while(ans == "y" || ans == "Y");
+    delete pool;
+    if(STATS_ENABLED && !writeStats(statsPath())) cerr << "cannot write " << statsPath() << endl;
+    cout << "Thanks for playing!";
 }
 
-bool Board::checkGameStatus()
+// Endless mode: the view is a window of the plane centred on the last move. Rows and columns
+// are absolute and may be negative, and the game starts by opening (0, 0), which is always
+// safe. There is no win; Q as the action ends the game.
+static void playEndless(int bombsPerChunk)
 {
-    for(int i = 0; i < m_rows; i++){
-        for(int j = 0; j < m_cols; j++){
-            if(!m_grid[i][j].isOpened() && !m_grid[i][j].isBomb()){
-                return false;
+    const int viewRows = 16, viewCols = 30;
+    EndlessBoard board(chrono::steady_clock::now().time_since_epoch().count(), bombsPerChunk);
+    int64_t r = 0, c = 0;
+    MoveResult result = board.processMove(r, c);
+    while(true){
+        int64_t top = r - viewRows / 2, left = c - viewCols / 2;
+        cout << "-----------------------" << endl;
+        cout << "columns " << left << " to " << left + viewCols - 1 << ", last digit shown" << endl << "        ";
+        for(int64_t j = left; j < left + viewCols; j++){
+            cout << ((j % 10 + 10) % 10) << ' ';
+        }
+        cout << endl;
+        for(int64_t i = top; i < top + viewRows; i++){
+            string label = to_string(i);
+            cout << string(label.size() < 6 ? 6 - label.size() : 0, ' ') << label << "| ";
+            for(int64_t j = left; j < left + viewCols; j++){
+                const Cell& cell = board.getCell(i, j);
+                char value = !board.stillPlaying() ? cell.getValue() : cell.getFlag() ? 'F' : cell.getDisplayValue();
+                cout << value << ' ';
             }
+            cout << endl;
+        }
+        cout << "Opened: " << board.getOpenedCount() << ", Flags: " << board.getFlagCount() << endl;
+        if(result == MOVE_FLAGGED) cout << "You can't open this. It is flagged!" << endl;
+        else if(result == MOVE_ALREADY_OPEN) cout << "Invalid Move" << endl;
+        else if(result == MOVE_INVALID) cout << "Invalid action!" << endl;
+        if(!board.stillPlaying()){
+            cout << bold << colorThree << "You Lost!" << reset << endl;
+            return;
         }
+        cout << "Make your move: row# col#: ";
+        int64_t row, col;
+        string a;
+        if(!(cin >> row >> col)) return;
+        cout << "What action do you want to do? (O)pen/(F)lag/(Q)uit: ";
+        cin >> a;
+        if(a == "Q" || a == "q"){
+            cout << "You quit the game!" << endl;
+            return;
+        }
+        r = row;
+        c = col;
+        if(a == "F" || a == "f") result = board.flagCell(r, c);
+        else if(a == "O" || a == "o") result = board.processMove(r, c);
+        else result = MOVE_INVALID;
     }
-    return true;
 }
 
-bool Board::isNeighbor(int r1, int c1, int r2, int c2)
+void Game::displayBoard()
 {
-    return (abs(r1 - r2) <= 1) && (abs(c1 - c2) <= 1);
+    cout.flush();
+    m_renderer.draw(*m_board, m_gameOver);
 }
 
-Game::Game()
+Game::Game(BoardPool* boards, NoGuessPool* pool, MoveLogWriter* log)
 {
+    m_boards = boards;
+    m_pool = pool;
+    m_log = log;
     m_gameOver = false;
     cout << "Choose a level of difficulty" << endl;
     string inputchar;
@@ -369,14 +193,20 @@ Game::Game()
         cin >> inputchar;
     }while(inputchar != "E" && inputchar != "M" && inputchar != "H" && inputchar != "e" && inputchar != "m" && inputchar != "h");
     if(inputchar == "E" || inputchar == "e"){
-        m_board = new Board(this, 10, 10, 10);
+        m_board = m_boards->acquire(10, 10, 10);
     }
     else if (inputchar == "M" || inputchar == "m"){
-        m_board = new Board(this, 18, 18, 40);
+        m_board = m_boards->acquire(18, 18, 40);
     }
     else{
-        m_board = new Board(this, 24, 24, 99);
+        m_board = m_boards->acquire(24, 24, 99);
     }
+    m_board->trackHistory(&m_history);
+}
+
+Game::~Game()
+{
+    m_boards->release(m_board);
 }
 
 void Game::endGame(bool won)
@@ -402,13 +232,26 @@ bool Game::getGameVal()
 }
 
 void Game::play(){
-    m_board->displayBoard();
+    m_log->beginGame();
+    displayBoard();
     cout << "Make your move (row# col#): " ;
     int r, c;
     string a;
     cin >> r >> c;
-    m_board->handleFirstClick(r, c);
-    m_board->displayBoard();
+    while(!m_board->checkMove(r, c)){
+        cout << "Not the right format (row number, space, then column number)" << endl;
+        cout << "Try again: ";
+        cin >> r >> c;
+    }
+    uint64_t seed;
+    if(m_pool){
+        if(m_pool->take(m_board->getRows(), m_board->getCols(), m_board->getRequestedBombs(), r, c, seed)) m_board->setSeed(seed);
+        else cout << "No no-guess board was found for this level and first click, so this one may need a guess." << endl;
+    }
+    MoveResult first = m_board->handleFirstClick(r, c);
+    m_log->record(*m_board, ACTION_FIRST_CLICK, r, c);
+    m_log->flush();
+    showMove(first);
     while(!m_gameOver){
         cout << "Make your move: row# col#: ";
         cin >> r >> c;
@@ -416,14 +259,68 @@ void Game::play(){
             quit();
             break;
         }
-        cout << "What action do you want to do? (O)pen/(F)lag: ";
+        cout << "What action do you want to do? (O)pen/(F)lag/(U)ndo/(R)edo: ";
         cin >> a;
-        if(a == "F" || a == "f") m_board->flagCell(r, c);
-        else if(a == "O" || a == "o") m_board->processMove(r,c);
-        else cout << "Invalid action!" << endl;
-        if(m_board->checkGameStatus()) endGame(true);
-        m_board->displayBoard();
+        if(a == "F" || a == "f"){
+            MoveResult result = m_board->flagCell(r, c);
+            m_log->record(*m_board, ACTION_FLAG, r, c);
+            m_log->flush();
+            displayBoard();
+            if(result == MOVE_ALREADY_OPEN) cout << "Don't flag this. It's already open!" << endl;
+            else if(result == MOVE_INVALID) cout << "Invalid Move" << endl;
+        }
+        else if(a == "O" || a == "o"){
+            MoveResult result = m_board->processMove(r,c);
+            m_log->record(*m_board, ACTION_OPEN, r, c);
+            m_log->flush();
+            showMove(result);
+        }
+        // the first click stays, since the game loop starts after it
+        else if(a == "U" || a == "u"){
+            if(m_history.getEntryCount() > 1 && m_board->undo()){
+                m_log->record(*m_board, ACTION_UNDO, 0, 0);
+                m_log->flush();
+                displayBoard();
+            }
+            else{
+                displayBoard();
+                cout << "Nothing to undo" << endl;
+            }
+        }
+        else if(a == "R" || a == "r"){
+            if(m_board->redo()){
+                m_log->record(*m_board, ACTION_REDO, 0, 0);
+                m_log->flush();
+                GameState state = m_board->getState();
+                showMove(state == GAME_LOST ? MOVE_BOMB : state == GAME_WON ? MOVE_WON : MOVE_OK);
+            }
+            else{
+                displayBoard();
+                cout << "Nothing to redo" << endl;
+            }
+        }
+        else{
+            displayBoard();
+            cout << "Invalid action!" << endl;
+        }
     }
 }
 
+// The board is redrawn first so the message lands on the line under it. A finished game is
+// drawn with every cell revealed.
+void Game::showMove(MoveResult result)
+{
+    if(result == MOVE_BOMB || result == MOVE_WON) m_gameOver = true;
+    displayBoard();
+    reportMove(result);
+}
+
+void Game::reportMove(MoveResult result)
+{
+    if(result == MOVE_FLAGGED) cout << "You can't open this. It is flagged!" << endl;
+    else if(result == MOVE_INVALID || result == MOVE_ALREADY_OPEN) cout << "Invalid Move" << endl;
+    else if(result == MOVE_BOMB) endGame(false);
+    else if(result == MOVE_WON) endGame(true);
+}
+
 //text color
\ No newline at end of file
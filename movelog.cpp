@@ -0,0 +1,239 @@
+#include "movelog.h"
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+using namespace std;
+
+static const char MAGIC[8] = {'M', 'S', 'W', 'P', 'M', 'L', 'O', 'G'};
+// buffered records are written out once they pass this size
+const size_t FLUSH_BYTES = 1 << 16;
+
+MoveLogWriter::MoveLogWriter()
+{
+    m_fd = -1;
+    m_gamePending = false;
+}
+
+MoveLogWriter::~MoveLogWriter()
+{
+    close();
+}
+
+bool MoveLogWriter::open(const string& path)
+{
+    close();
+    m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(m_fd < 0){
+        m_error = "cannot create " + path + ": " + strerror(errno);
+        return false;
+    }
+    m_buffer.assign(MAGIC, sizeof(MAGIC));
+    appendFixed(MOVE_LOG_VERSION, 4);
+    m_error.clear();
+    return flush();
+}
+
+void MoveLogWriter::beginGame()
+{
+    m_gamePending = true;
+    m_last = chrono::steady_clock::now();
+}
+
+void MoveLogWriter::appendVarint(uint64_t value)
+{
+    while(value >= 0x80){
+        m_buffer += char(value | 0x80);
+        value >>= 7;
+    }
+    m_buffer += char(value);
+}
+
+void MoveLogWriter::appendFixed(uint64_t value, int bytes)
+{
+    for(int i = 0; i < bytes; i++){
+        m_buffer += char(value >> (8 * i));
+    }
+}
+
+void MoveLogWriter::record(const Board& board, MoveAction action, int row, int col)
+{
+    if(m_fd < 0 || row < 0 || col < 0 || row >= board.getRows() || col >= board.getCols()) return;
+    if(m_gamePending){
+        appendVarint(ACTION_GAME);
+        appendVarint(board.getRows());
+        appendVarint(board.getCols());
+        appendVarint(board.getRequestedBombs());
+        appendFixed(board.getSeed(), 8);
+        m_gamePending = false;
+    }
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    uint64_t cell = uint64_t(row) * board.getCols() + col;
+    appendVarint(cell << 3 | action);
+    appendVarint(chrono::duration_cast<chrono::milliseconds>(now - m_last).count());
+    appendFixed(board.getStateHash() & 0xFFFF, 2);
+    m_last = now;
+    if(m_buffer.size() >= FLUSH_BYTES) flush();
+}
+
+bool MoveLogWriter::flush()
+{
+    size_t done = 0;
+    while(m_fd >= 0 && done < m_buffer.size()){
+        ssize_t written = write(m_fd, m_buffer.data() + done, m_buffer.size() - done);
+        if(written < 0){
+            if(errno == EINTR) continue;
+            m_error = string("cannot write the move log: ") + strerror(errno);
+            m_buffer.clear();
+            return false;
+        }
+        done += written;
+    }
+    m_buffer.clear();
+    return true;
+}
+
+bool MoveLogWriter::close()
+{
+    if(m_fd < 0) return true;
+    bool flushed = flush();
+    if(::close(m_fd) != 0) flushed = false;
+    m_fd = -1;
+    return flushed;
+}
+
+bool MoveLogWriter::isOpen() const
+{
+    return m_fd >= 0;
+}
+
+const string& MoveLogWriter::getError() const
+{
+    return m_error;
+}
+
+MoveLogReader::MoveLogReader()
+{
+    m_position = 0;
+    m_cells = 0;
+}
+
+bool MoveLogReader::open(const string& path)
+{
+    m_data.clear();
+    m_position = 0;
+    m_cells = 0;
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0){
+        m_error = "cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+    unsigned char chunk[1 << 16];
+    ssize_t got;
+    while((got = read(fd, chunk, sizeof(chunk))) != 0){
+        if(got < 0){
+            if(errno == EINTR) continue;
+            m_error = "cannot read " + path + ": " + strerror(errno);
+            ::close(fd);
+            return false;
+        }
+        m_data.insert(m_data.end(), chunk, chunk + got);
+    }
+    ::close(fd);
+    uint64_t version;
+    if(m_data.size() < sizeof(MAGIC) + 4 || memcmp(m_data.data(), MAGIC, sizeof(MAGIC)) != 0){
+        m_error = path + " is not a move log";
+        return false;
+    }
+    m_position = sizeof(MAGIC);
+    readFixed(version, 4);
+    if(version != MOVE_LOG_VERSION){
+        m_error = path + " is move log version " + to_string(version) + ", expected " + to_string(MOVE_LOG_VERSION);
+        return false;
+    }
+    m_error.clear();
+    return true;
+}
+
+bool MoveLogReader::readVarint(uint64_t& value)
+{
+    value = 0;
+    for(int shift = 0; shift < 64 && m_position < m_data.size(); shift += 7){
+        unsigned char byte = m_data[m_position++];
+        value |= uint64_t(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool MoveLogReader::readFixed(uint64_t& value, int bytes)
+{
+    if(m_data.size() - m_position < size_t(bytes)) return false;
+    value = 0;
+    for(int i = 0; i < bytes; i++){
+        value |= uint64_t(m_data[m_position++]) << (8 * i);
+    }
+    return true;
+}
+
+bool MoveLogReader::next(GameEntry& game, MoveEntry& move, MoveAction& kind)
+{
+    if(m_position >= m_data.size()) return false;
+    uint64_t code, rows, cols, bombs, seed, millis, check;
+    if(!readVarint(code)){
+        m_error = "truncated record";
+        return false;
+    }
+    kind = MoveAction(code & 7);
+    if(kind == ACTION_GAME){
+        if(!readVarint(rows) || !readVarint(cols) || !readVarint(bombs) || !readFixed(seed, 8)){
+            m_error = "truncated game record";
+            return false;
+        }
+        if(rows < 1 || cols < 1 || rows > INT_MAX || cols > INT_MAX || rows * cols > INT_MAX || bombs > rows * cols){
+            m_error = "damaged game record";
+            return false;
+        }
+        m_cells = rows * cols;
+        game.rows = int(rows);
+        game.cols = int(cols);
+        game.bombs = int(bombs);
+        game.seed = seed;
+        return true;
+    }
+    if(kind > ACTION_CHORD){
+        m_error = "unknown action " + to_string(int(kind));
+        return false;
+    }
+    if((code >> 3) >= m_cells){
+        m_error = m_cells ? "move off the board" : "move before the first game record";
+        return false;
+    }
+    if(!readVarint(millis) || !readFixed(check, 2)){
+        m_error = "truncated move record";
+        return false;
+    }
+    move.cell = int(code >> 3);
+    move.action = kind;
+    move.millis = uint32_t(millis);
+    move.check = uint16_t(check);
+    return true;
+}
+
+const string& MoveLogReader::getError() const
+{
+    return m_error;
+}
+
+bool replayMove(Board& board, const MoveEntry& move)
+{
+    int row = move.cell / board.getCols(), col = move.cell % board.getCols();
+    if(move.action == ACTION_FIRST_CLICK) board.handleFirstClick(row, col);
+    else if(move.action == ACTION_OPEN) board.processMove(row, col);
+    else if(move.action == ACTION_FLAG) board.flagCell(row, col);
+    else if(move.action == ACTION_CHORD) board.chordCell(row, col);
+    else if(move.action == ACTION_UNDO) board.undo();
+    else board.redo();
+    return (board.getStateHash() & 0xFFFF) == move.check;
+}
@@ -0,0 +1,105 @@
+#ifndef MOVELOG_H
+#define MOVELOG_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "board.h"
+
+// Move logs: a compact record of played games, enough to replay them exactly. A log starts
+// with the magic "MSWPMLOG" and a 4-byte little-endian format version, then holds a stream of
+// records, each opening with a varint `code`:
+//
+//   code = cell index << 3 | action       a move, followed by
+//     varint   milliseconds since the previous record of the game
+//     2 bytes  the low 16 bits of the board's state hash after the move, little-endian
+//   code = ACTION_GAME                    a new game, followed by
+//     varint   rows, cols, and the bombs asked for, which placeMines may lower
+//     8 bytes  seed, little-endian
+//
+// A move costs 4 to 7 bytes. The hash lets a replay stop at the first move where the engine no
+// longer agrees with the recording.
+enum MoveAction{
+    ACTION_FIRST_CLICK, // handleFirstClick
+    ACTION_OPEN,        // processMove
+    ACTION_FLAG,        // flagCell
+    ACTION_UNDO,        // Board::undo, recorded with cell 0
+    ACTION_REDO,        // Board::redo, recorded with cell 0
+    ACTION_CHORD,       // chordCell
+    ACTION_GAME = 7     // the game record; never a move
+};
+
+// version 2 added undo and redo, and hashes flags by position only; version 3 hashes cells by
+// their index in the sentinel-padded grid
+const uint32_t MOVE_LOG_VERSION = 3;
+
+struct MoveEntry{
+    int cell;
+    MoveAction action;
+    uint32_t millis;    // since the previous record
+    uint16_t check;     // low bits of the state hash after the move
+};
+
+struct GameEntry{
+    int rows;
+    int cols;
+    int bombs;
+    uint64_t seed;
+};
+
+class MoveLogWriter{
+    public:
+        MoveLogWriter();
+        // Flushes and closes.
+        ~MoveLogWriter();
+        // Creates `path`, replacing any file there.
+        bool open(const std::string& path);
+        // The next move starts a new game. Its record is written with that move, since a
+        // no-guess seed is only set just before the first click.
+        void beginGame();
+        // Records a move that has just been applied to `board`. Moves off the board are not
+        // recorded. Records are buffered; call flush() to make sure they reach the file.
+        void record(const Board& board, MoveAction action, int row, int col);
+        bool flush();
+        bool close();
+        bool isOpen() const;
+        const std::string& getError() const;
+    private:
+        MoveLogWriter(const MoveLogWriter&);
+        MoveLogWriter& operator=(const MoveLogWriter&);
+        void appendVarint(uint64_t value);
+        void appendFixed(uint64_t value, int bytes);
+        std::string m_buffer;
+        std::string m_error;
+        int m_fd;
+        bool m_gamePending;
+        std::chrono::steady_clock::time_point m_last;
+};
+
+// Reads a whole log into memory and decodes it record by record.
+class MoveLogReader{
+    public:
+        MoveLogReader();
+        bool open(const std::string& path);
+        // Decodes the next record into `game` or `move` and returns which: ACTION_GAME or the
+        // move's action. Returns false at the end of the log, or at a damaged record, which
+        // also sets the error.
+        bool next(GameEntry& game, MoveEntry& move, MoveAction& kind);
+        const std::string& getError() const;
+    private:
+        bool readVarint(uint64_t& value);
+        bool readFixed(uint64_t& value, int bytes);
+        std::vector<unsigned char> m_data;
+        size_t m_position;
+        // cells on the current game's board, 0 before the first game record
+        uint64_t m_cells;
+        std::string m_error;
+};
+
+// Applies one recorded move to `board` and reports whether the board's state hash still
+// matches the recording. Undo and redo need the board to be tracking a History.
+bool replayMove(Board& board, const MoveEntry& move);
+
+#endif
@@ -0,0 +1,185 @@
+#include "noguess.h"
+#include <tuple>
+using namespace std;
+
+// candidates a pool worker checks before handing its finds back
+const int CANDIDATE_BLOCK = 32;
+
+bool isNoGuess(Board& scratch, Solver& solver, uint64_t seed, int row, int col)
+{
+    static thread_local vector<int> safe, mines;
+    int cols = scratch.getCols();
+    scratch.reset();
+    scratch.setSeed(seed);
+    if(scratch.handleFirstClick(row, col) == MOVE_INVALID) return false;
+    while(scratch.stillPlaying()){
+        safe.clear();
+        mines.clear();
+        if(!solver.solve(scratch, safe, mines)) return false;
+        for(int cell : mines){
+            scratch.flagCell(cell / cols, cell % cols);
+        }
+        for(int cell : safe){
+            scratch.processMove(cell / cols, cell % cols);
+        }
+    }
+    return scratch.getWin();
+}
+
+bool findNoGuessSeed(int rows, int cols, int bombs, int row, int col, uint64_t firstSeed, int threads, uint64_t& seed)
+{
+    if(threads < 1) threads = 1;
+    uint64_t end = firstSeed > UINT64_MAX - NO_GUESS_ATTEMPTS ? UINT64_MAX : firstSeed + NO_GUESS_ATTEMPTS;
+    atomic<uint64_t> best(end);
+    vector<thread> workers;
+    for(int t = 0; t < threads; t++){
+        workers.emplace_back([&, t](){
+            Board scratch(rows, cols, bombs);
+            Solver solver;
+            for(uint64_t candidate = firstSeed + t; candidate < best.load(); candidate += threads){
+                if(!isNoGuess(scratch, solver, candidate, row, col)) continue;
+                uint64_t current = best.load();
+                while(candidate < current && !best.compare_exchange_weak(current, candidate)){}
+                return;
+            }
+        });
+    }
+    for(thread& worker : workers){
+        worker.join();
+    }
+    seed = best.load();
+    return seed < end;
+}
+
+bool NoGuessPool::Key::operator<(const Key& other) const
+{
+    return tie(rows, cols, bombs, row, col) < tie(other.rows, other.cols, other.bombs, other.row, other.col);
+}
+
+NoGuessPool::NoGuessPool(int threads, int depth, uint64_t firstSeed)
+{
+    m_threads = threads < 1 ? 1 : threads;
+    m_depth = depth < 1 ? 1 : depth;
+    m_firstSeed = firstSeed;
+    m_stopping = false;
+    for(int i = 0; i < m_threads; i++){
+        m_workers.emplace_back(&NoGuessPool::work, this);
+    }
+}
+
+NoGuessPool::~NoGuessPool()
+{
+    {
+        lock_guard<mutex> guard(m_lock);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for(thread& worker : m_workers){
+        worker.join();
+    }
+}
+
+NoGuessPool::Entry& NoGuessPool::entry(const Key& key)
+{
+    map<Key, Entry>::iterator found = m_entries.find(key);
+    if(found != m_entries.end()) return found->second;
+    Entry& created = m_entries[key];
+    created.nextCandidate = m_firstSeed;
+    created.searching = 0;
+    created.waiting = 0;
+    created.misses = 0;
+    created.givenUp = false;
+    m_wake.notify_all();
+    return created;
+}
+
+void NoGuessPool::prepare(int rows, int cols, int bombs, int row, int col)
+{
+    Key key = {rows, cols, bombs, row, col};
+    lock_guard<mutex> guard(m_lock);
+    entry(key);
+}
+
+bool NoGuessPool::take(int rows, int cols, int bombs, int row, int col, uint64_t& seed)
+{
+    Key key = {rows, cols, bombs, row, col};
+    unique_lock<mutex> lock(m_lock);
+    Entry& ready = entry(key);
+    if(ready.seeds.empty() && !ready.givenUp){
+        ready.waiting++;
+        m_wake.notify_all();
+        while(ready.seeds.empty() && !ready.givenUp){
+            m_wake.wait(lock);
+        }
+        ready.waiting--;
+    }
+    if(ready.seeds.empty()) return false;
+    seed = ready.seeds.front();
+    ready.seeds.pop_front();
+    m_wake.notify_all();
+    return true;
+}
+
+int NoGuessPool::ready(int rows, int cols, int bombs, int row, int col)
+{
+    Key key = {rows, cols, bombs, row, col};
+    lock_guard<mutex> guard(m_lock);
+    map<Key, Entry>::iterator found = m_entries.find(key);
+    return found == m_entries.end() ? 0 : found->second.seeds.size();
+}
+
+// Each worker repeatedly claims a block of candidate seeds for a configuration that is short
+// of seeds, checks them without holding the lock, and files the ones that qualify. A
+// configuration a caller is waiting for comes first and takes every worker, whatever the depth.
+// One that has gone NO_GUESS_ATTEMPTS candidates without a find is given up on, which wakes
+// its callers.
+void NoGuessPool::work()
+{
+    Board* scratch = nullptr;
+    Solver solver;
+    unique_lock<mutex> lock(m_lock);
+    while(!m_stopping){
+        Entry* target = nullptr;
+        Key key;
+        for(map<Key, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); it++){
+            if(it->second.givenUp) continue;
+            if(it->second.waiting > 0){
+                target = &it->second;
+                key = it->first;
+                break;
+            }
+            if(!target && it->second.seeds.size() + it->second.searching < m_depth){
+                target = &it->second;
+                key = it->first;
+            }
+        }
+        if(!target){
+            m_wake.wait(lock);
+            continue;
+        }
+        uint64_t first = target->nextCandidate;
+        target->nextCandidate += CANDIDATE_BLOCK;
+        target->searching++;
+        lock.unlock();
+
+        if(!scratch || scratch->getRows() != key.rows || scratch->getCols() != key.cols || scratch->getRequestedBombs() != key.bombs){
+            delete scratch;
+            scratch = new Board(key.rows, key.cols, key.bombs);
+        }
+        uint64_t found[CANDIDATE_BLOCK];
+        int count = 0;
+        for(uint64_t seed = first; seed < first + CANDIDATE_BLOCK; seed++){
+            if(isNoGuess(*scratch, solver, seed, key.row, key.col)) found[count++] = seed;
+        }
+
+        lock.lock();
+        target->searching--;
+        for(int i = 0; i < count; i++){
+            target->seeds.push_back(found[i]);
+        }
+        target->misses = count > 0 ? 0 : target->misses + CANDIDATE_BLOCK;
+        if(target->misses >= NO_GUESS_ATTEMPTS) target->givenUp = true;
+        if(count > 0 || target->givenUp) m_wake.notify_all();
+    }
+    delete scratch;
+}
@@ -0,0 +1,76 @@
+#ifndef NOGUESS_H
+#define NOGUESS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "board.h"
+#include "solver.h"
+
+// No-guess boards. A board is fully determined by its size, bomb count, seed and first click,
+// so a no-guess board is stored as a seed: the caller calls setSeed() on a fresh board and then
+// handleFirstClick() on the same cell. A seed qualifies when the solver can clear the board
+// from that first click by deduction alone.
+
+// Candidates checked for a configuration without finding a qualifying seed before it is given
+// up on, as happens when the board is too dense to ever clear by deduction.
+const uint64_t NO_GUESS_ATTEMPTS = 1 << 16;
+
+// Replays the board for `seed` on `scratch` (which must have the wanted size and bomb count).
+// Returns true if deduction alone wins it.
+bool isNoGuess(Board& scratch, Solver& solver, uint64_t seed, int row, int col);
+
+// Smallest qualifying seed among the NO_GUESS_ATTEMPTS candidates from `firstSeed`, into
+// `seed`. Candidates are split across `threads` workers, which stop once every smaller
+// candidate has been checked. False if none qualifies.
+bool findNoGuessSeed(int rows, int cols, int bombs, int row, int col, uint64_t firstSeed, int threads, uint64_t& seed);
+
+// Ready no-guess seeds per (rows, cols, bombs, first click), kept topped up by background
+// workers, so serving a board is a queue pop instead of a search.
+class NoGuessPool{
+    public:
+        NoGuessPool(int threads, int depth, uint64_t firstSeed);
+        ~NoGuessPool();
+        // Starts keeping seeds ready for this configuration.
+        void prepare(int rows, int cols, int bombs, int row, int col);
+        // A qualifying seed for this configuration, into `seed`. Served from the pool when one
+        // is ready; otherwise waits, and while it does, the workers search this configuration
+        // before topping up any other. False once NO_GUESS_ATTEMPTS candidates in a row have
+        // failed for it, which it then keeps returning.
+        bool take(int rows, int cols, int bombs, int row, int col, uint64_t& seed);
+        int ready(int rows, int cols, int bombs, int row, int col);
+    private:
+        struct Key{
+            int rows;
+            int cols;
+            int bombs;
+            int row;
+            int col;
+            bool operator<(const Key& other) const;
+        };
+        struct Entry{
+            std::deque<uint64_t> seeds;
+            uint64_t nextCandidate;
+            int searching;
+            int waiting;    // callers blocked in take()
+            uint64_t misses; // candidates checked since the last one that qualified
+            bool givenUp;   // misses reached NO_GUESS_ATTEMPTS; nothing is searched any more
+        };
+        void work();
+        Entry& entry(const Key& key);
+        std::map<Key, Entry> m_entries;
+        std::mutex m_lock;
+        std::condition_variable m_wake;
+        std::vector<std::thread> m_workers;
+        int m_threads;
+        size_t m_depth;
+        uint64_t m_firstSeed;
+        bool m_stopping;
+};
+
+#endif
@@ -0,0 +1,9 @@
+#include "presetboard.h"
+
+Board* newBoard(int rows, int cols, int bombs)
+{
+    if(rows == 10 && cols == 10) return new PresetBoard<10, 10>(bombs);
+    if(rows == 18 && cols == 18) return new PresetBoard<18, 18>(bombs);
+    if(rows == 24 && cols == 24) return new PresetBoard<24, 24>(bombs);
+    return new Board(rows, cols, bombs);
+}
@@ -0,0 +1,82 @@
+#ifndef PRESETBOARD_H
+#define PRESETBOARD_H
+
+#include <array>
+#include "board.h"
+
+// Boards whose size is fixed at compile time, for the standard levels. A PresetBoard is a
+// Board, so everything that takes a Board plays on it unchanged, but its cells sit in a
+// std::array inside the object and its flood fill and bomb counting are compiled for its exact
+// size: every bound is a constant and the neighbours of a cell are constant offsets.
+
+template<int Rows, int Cols>
+struct PresetLayout{
+    static constexpr int STRIDE = Cols + 2;
+    // Counting runs over whole grid rows, sentinel columns and all, rounded up to a multiple
+    // of the vector width so the compiler can vectorise it with no remainder loop.
+    static constexpr int SPAN = (Rows * STRIDE + 31) / 32 * 32;
+    // the grid, and the cells past it that the rounded up count reads
+    static constexpr int CELLS = (Rows + 2) * STRIDE + SPAN - Rows * STRIDE + 2;
+};
+
+// Holds the cells ahead of the Board base, so they exist when the board is built on them.
+template<int Rows, int Cols>
+struct PresetCells{
+    std::array<Cell, PresetLayout<Rows, Cols>::CELLS> m_storage;
+};
+
+template<int Rows, int Cols>
+class PresetBoard : private PresetCells<Rows, Cols>, public Board{
+    public:
+        PresetBoard(int bombs);
+    private:
+        typedef PresetLayout<Rows, Cols> Layout;
+        static constexpr std::array<int, 8> NEIGHBOURS = {
+            -Layout::STRIDE - 1, -Layout::STRIDE, -Layout::STRIDE + 1, -1, 1, Layout::STRIDE - 1, Layout::STRIDE, Layout::STRIDE + 1
+        };
+        static void fill(Board& board, int index);
+        static void count(Board& board);
+        static const Kernels KERNELS;
+};
+
+template<int Rows, int Cols>
+const Board::Kernels PresetBoard<Rows, Cols>::KERNELS = {fill, count};
+
+template<int Rows, int Cols>
+PresetBoard<Rows, Cols>::PresetBoard(int bombs) : Board(Rows, Cols, bombs, this->m_storage.data())
+{
+    m_kernels = &KERNELS;
+    markSentinels();
+}
+
+template<int Rows, int Cols>
+void PresetBoard<Rows, Cols>::fill(Board& board, int index)
+{
+    board.fillFrom(FixedShape<Rows, Cols>(), index);
+}
+
+// Every cell sums the bomb bits at the same eight offsets, the sentinels supplying the zeros
+// past the edges, one offset at a time across the whole grid.
+template<int Rows, int Cols>
+void PresetBoard<Rows, Cols>::count(Board& board)
+{
+    unsigned char* cells = reinterpret_cast<unsigned char*>(board.m_grid);
+    unsigned char counts[Layout::SPAN] = {};
+    for(int offset : NEIGHBOURS){
+        for(int i = 0; i < Layout::SPAN; i++){
+            counts[i] += (cells[i + offset] & 0x10) != 0;
+        }
+    }
+    for(int r = 0; r < Rows; r++){
+        for(int c = 0; c < Cols; c++){
+            unsigned char& cell = cells[r * Layout::STRIDE + c];
+            cell = (cell & 0xF0) | counts[r * Layout::STRIDE + c];
+        }
+    }
+}
+
+// A board of this size: a PresetBoard for the sizes of the easy, medium and hard levels
+// (10x10, 18x18 and 24x24, with any bomb count), a Board otherwise.
+Board* newBoard(int rows, int cols, int bombs);
+
+#endif
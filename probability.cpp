@@ -0,0 +1,308 @@
+#include "probability.h"
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+static double logChoose(int n, int k)
+{
+    if(k < 0 || k > n) return -INFINITY;
+    return lgamma(n + 1.0) - lgamma(k + 1.0) - lgamma(n - k + 1.0);
+}
+
+static vector<double> convolve(const vector<double>& a, const vector<double>& b)
+{
+    vector<double> result(a.size() + b.size() - 1, 0.0);
+    for(size_t i = 0; i < a.size(); i++){
+        if(a[i] == 0) continue;
+        for(size_t j = 0; j < b.size(); j++){
+            result[i + j] += a[i] * b[j];
+        }
+    }
+    return result;
+}
+
+bool ProbabilityEngine::compute(const Board& board, vector<double>& probabilities)
+{
+    m_rows = board.getRows();
+    m_cols = board.getCols();
+    m_constraints.clear();
+    m_components.clear();
+    m_closedCells.clear();
+    m_frontierSize = 0;
+    buildConstraints(board);
+    for(const Constraint& constraint : m_constraints){
+        if(constraint.need < 0 || constraint.need > (int)constraint.cells.size()) return false;
+    }
+    buildComponents();
+    for(Component& component : m_components){
+        solveComponent(component);
+        double scale = *max_element(component.ways.begin(), component.ways.end());
+        if(scale == 0) return false;
+        // only ratios matter, so each component is rescaled to keep products of many components in range
+        for(double& ways : component.ways) ways /= scale;
+        for(vector<double>& bombWays : component.bombWays){
+            for(double& ways : bombWays) ways /= scale;
+        }
+    }
+
+    int interior = m_closedCells.size() - m_frontierSize;
+    int remaining = board.getBombs() - board.getFlagCount();
+    int components = m_components.size();
+
+    // prefix[i] combines components before i, suffix[i] components from i on
+    vector<vector<double>> prefix(components + 1), suffix(components + 1);
+    prefix[0] = vector<double>(1, 1.0);
+    suffix[components] = vector<double>(1, 1.0);
+    for(int i = 0; i < components; i++){
+        prefix[i + 1] = convolve(prefix[i], m_components[i].ways);
+    }
+    for(int i = components - 1; i >= 0; i--){
+        suffix[i] = convolve(m_components[i].ways, suffix[i + 1]);
+    }
+    const vector<double>& total = prefix[components];
+
+    // weight[k]: ways to place the bombs left over once the frontier holds k, scaled to the largest
+    int frontierMax = total.size() - 1;
+    vector<double> weight(frontierMax + 1);
+    double largest = -INFINITY;
+    for(int k = 0; k <= frontierMax; k++){
+        weight[k] = logChoose(interior, remaining - k);
+        largest = max(largest, weight[k]);
+    }
+    if(largest == -INFINITY) return false;
+    double denominator = 0;
+    double interiorBombs = 0;
+    for(int k = 0; k <= frontierMax; k++){
+        weight[k] = exp(weight[k] - largest);
+        denominator += total[k] * weight[k];
+        interiorBombs += total[k] * weight[k] * (remaining - k);
+    }
+    if(denominator == 0) return false;
+
+    probabilities.assign(m_rows * m_cols, 0.0);
+    for(int r = 0; r < m_rows; r++){
+        for(int c = 0; c < m_cols; c++){
+            if(board.getCell(r, c).getFlag()) probabilities[r * m_cols + c] = 1.0;
+        }
+    }
+    double interiorProbability = interior > 0 ? interiorBombs / denominator / interior : 0.0;
+    for(int cell : m_closedCells){
+        probabilities[cell] = interiorProbability;
+    }
+    for(int i = 0; i < components; i++){
+        Component& component = m_components[i];
+        vector<double> others = convolve(prefix[i], suffix[i + 1]);
+        vector<double> g(component.ways.size(), 0.0);
+        for(size_t k = 0; k < g.size(); k++){
+            for(size_t rest = 0; rest < others.size() && k + rest < weight.size(); rest++){
+                g[k] += others[rest] * weight[k + rest];
+            }
+        }
+        for(size_t j = 0; j < component.cells.size(); j++){
+            double bombs = 0;
+            for(size_t k = 0; k < g.size(); k++){
+                bombs += component.bombWays[j][k] * g[k];
+            }
+            probabilities[component.cells[j]] = bombs / denominator;
+        }
+    }
+    return true;
+}
+
+int ProbabilityEngine::getFrontierSize() const
+{
+    return m_frontierSize;
+}
+
+int ProbabilityEngine::getComponentCount() const
+{
+    return m_components.size();
+}
+
+void ProbabilityEngine::buildConstraints(const Board& board)
+{
+    m_frontierIndex.assign(m_rows * m_cols, -1);
+    for(int r = 0; r < m_rows; r++){
+        for(int c = 0; c < m_cols; c++){
+            const Cell& cell = board.getCell(r, c);
+            if(!cell.isOpened()){
+                if(!cell.getFlag()) m_closedCells.push_back(r * m_cols + c);
+                continue;
+            }
+            if(cell.getCount() == 0) continue;
+            Constraint constraint;
+            constraint.need = cell.getCount();
+            for(int nr = r - 1; nr <= r + 1; nr++){
+                for(int nc = c - 1; nc <= c + 1; nc++){
+                    if(nr < 0 || nr >= m_rows || nc < 0 || nc >= m_cols) continue;
+                    const Cell& neighbour = board.getCell(nr, nc);
+                    if(neighbour.getFlag()) constraint.need--;
+                    else if(!neighbour.isOpened()) constraint.cells.push_back(nr * m_cols + nc);
+                }
+            }
+            if(constraint.cells.empty()){
+                if(constraint.need != 0) constraint.need = -1;
+                else continue;
+            }
+            for(int neighbour : constraint.cells){
+                if(m_frontierIndex[neighbour] < 0) m_frontierIndex[neighbour] = m_frontierSize++;
+            }
+            m_constraints.push_back(constraint);
+        }
+    }
+}
+
+int ProbabilityEngine::find(int cell)
+{
+    while(m_parent[cell] != cell){
+        m_parent[cell] = m_parent[m_parent[cell]];
+        cell = m_parent[cell];
+    }
+    return cell;
+}
+
+// Frontier cells that share a number end up in the same component.
+void ProbabilityEngine::buildComponents()
+{
+    m_parent.resize(m_frontierSize);
+    for(int i = 0; i < m_frontierSize; i++){
+        m_parent[i] = i;
+    }
+    for(const Constraint& constraint : m_constraints){
+        int first = find(m_frontierIndex[constraint.cells[0]]);
+        for(int cell : constraint.cells){
+            m_parent[find(m_frontierIndex[cell])] = first;
+        }
+    }
+    vector<int> componentOf(m_frontierSize, -1);
+    for(int i = 0; i < (int)m_constraints.size(); i++){
+        int root = find(m_frontierIndex[m_constraints[i].cells[0]]);
+        if(componentOf[root] < 0){
+            componentOf[root] = m_components.size();
+            m_components.push_back(Component());
+        }
+        m_components[componentOf[root]].constraints.push_back(i);
+    }
+}
+
+// Counts the component's bomb layouts by bomb total. Cells are visited in breadth-first order
+// over shared numbers, so at any point only a few numbers are partly assigned. Their
+// outstanding bomb counts are the whole state of the search and key the memo. Per-cell counts
+// come from rerunning the search with one cell forced to a bomb. Memo entries past the forced
+// cell are unaffected by the forcing and are reused.
+void ProbabilityEngine::solveComponent(Component& component)
+{
+    // breadth-first cell order over shared numbers
+    vector<vector<int>> byCell;
+    vector<int> local(m_frontierSize, -1);
+    vector<int> cells;
+    for(int q : component.constraints){
+        for(int cell : m_constraints[q].cells){
+            int f = m_frontierIndex[cell];
+            if(local[f] < 0){
+                local[f] = cells.size();
+                cells.push_back(cell);
+                byCell.push_back(vector<int>());
+            }
+            byCell[local[f]].push_back(q);
+        }
+    }
+    int n = cells.size();
+    vector<int> position(n, -1);
+    m_order.clear();
+    for(int start = 0; start < n; start++){
+        if(position[start] >= 0) continue;
+        position[start] = m_order.size();
+        m_order.push_back(start);
+        for(size_t head = m_order.size() - 1; head < m_order.size(); head++){
+            for(int q : byCell[m_order[head]]){
+                for(int cell : m_constraints[q].cells){
+                    int l = local[m_frontierIndex[cell]];
+                    if(position[l] >= 0) continue;
+                    position[l] = m_order.size();
+                    m_order.push_back(l);
+                }
+            }
+        }
+    }
+
+    m_memberships.assign(n, vector<Membership>());
+    m_activeAt.assign(n + 1, vector<int>());
+    m_needs.resize(m_constraints.size());
+    for(int q : component.constraints){
+        vector<int> positions;
+        for(int cell : m_constraints[q].cells){
+            positions.push_back(position[local[m_frontierIndex[cell]]]);
+        }
+        sort(positions.begin(), positions.end());
+        for(size_t i = 0; i < positions.size(); i++){
+            Membership membership;
+            membership.constraint = q;
+            membership.cellsAfter = positions.size() - 1 - i;
+            m_memberships[positions[i]].push_back(membership);
+        }
+        for(int p = positions.front() + 1; p <= positions.back(); p++){
+            m_activeAt[p].push_back(q);
+        }
+        m_needs[q] = m_constraints[q].need;
+    }
+
+    m_memo.assign(n + 1, unordered_map<string, vector<double>>());
+    m_forced.assign(n, -1);
+    m_done.assign(1, 1.0);
+    m_none.clear();
+    component.cells.clear();
+    for(int p = 0; p < n; p++){
+        component.cells.push_back(cells[m_order[p]]);
+    }
+    component.ways = count(0);
+    component.ways.resize(n + 1, 0.0);
+    component.bombWays.assign(n, vector<double>());
+    for(int p = 0; p < n; p++){
+        for(int i = 0; i <= p; i++) m_memo[i].clear();
+        m_forced[p] = 1;
+        component.bombWays[p] = count(0);
+        component.bombWays[p].resize(n + 1, 0.0);
+        m_forced[p] = -1;
+        for(int i = 0; i <= p; i++) m_memo[i].clear();
+    }
+}
+
+// Layouts of the cells from `position` on, by bomb count, given the current outstanding counts.
+const vector<double>& ProbabilityEngine::count(int position)
+{
+    if(position == (int)m_order.size()) return m_done;
+    string key;
+    for(int q : m_activeAt[position]){
+        key.push_back(char(m_needs[q]));
+    }
+    unordered_map<string, vector<double>>& memo = m_memo[position];
+    unordered_map<string, vector<double>>::iterator found = memo.find(key);
+    if(found != memo.end()) return found->second;
+
+    vector<double> result;
+    for(int bomb = 0; bomb <= 1; bomb++){
+        if(m_forced[position] >= 0 && m_forced[position] != bomb) continue;
+        bool fits = true;
+        for(const Membership& membership : m_memberships[position]){
+            int need = m_needs[membership.constraint] - bomb;
+            if(need < 0 || need > membership.cellsAfter){
+                fits = false;
+                break;
+            }
+        }
+        if(!fits) continue;
+        for(const Membership& membership : m_memberships[position]){
+            m_needs[membership.constraint] -= bomb;
+        }
+        const vector<double>& rest = count(position + 1);
+        if(result.size() < rest.size() + bomb) result.resize(rest.size() + bomb, 0.0);
+        for(size_t k = 0; k < rest.size(); k++){
+            result[k + bomb] += rest[k];
+        }
+        for(const Membership& membership : m_memberships[position]){
+            m_needs[membership.constraint] += bomb;
+        }
+    }
+    return memo.emplace(key, result).first->second;
+}
@@ -0,0 +1,62 @@
+#ifndef PROBABILITY_H
+#define PROBABILITY_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "board.h"
+
+// Exact bomb probabilities for every closed cell, from what a player can see. Closed cells next
+// to a number (the frontier) are split into independent components that share no number. Each
+// component's valid bomb layouts are counted by bomb total with a memoised search. Then the
+// components and the cells away from the frontier are combined, weighted by how many ways the
+// remaining bombs can fill the rest. Flags are taken to be correct.
+class ProbabilityEngine{
+    public:
+        // Fills `probabilities` (row * cols + col) with each cell's chance of holding a bomb:
+        // 0 for opened cells, 1 for flagged ones. Returns false if no bomb layout fits the
+        // numbers, in which case `probabilities` is left untouched.
+        bool compute(const Board& board, std::vector<double>& probabilities);
+        int getFrontierSize() const;
+        int getComponentCount() const;
+    private:
+        struct Constraint{
+            int need;
+            std::vector<int> cells;
+        };
+        struct Membership{
+            int constraint;
+            int cellsAfter;
+        };
+        struct Component{
+            std::vector<int> cells;
+            std::vector<int> constraints;
+            std::vector<double> ways;
+            std::vector<std::vector<double>> bombWays;
+        };
+        void buildConstraints(const Board& board);
+        void buildComponents();
+        void solveComponent(Component& component);
+        const std::vector<double>& count(int position);
+        int find(int cell);
+        std::vector<Constraint> m_constraints;
+        std::vector<Component> m_components;
+        std::vector<int> m_parent;
+        std::vector<int> m_frontierIndex;
+        std::vector<int> m_closedCells;
+        int m_rows;
+        int m_cols;
+        int m_frontierSize;
+
+        // search state for the component being solved
+        std::vector<int> m_order;
+        std::vector<std::vector<Membership>> m_memberships;
+        std::vector<std::vector<int>> m_activeAt;
+        std::vector<int> m_needs;
+        std::vector<int> m_forced;
+        std::vector<std::unordered_map<std::string, std::vector<double>>> m_memo;
+        std::vector<double> m_done;
+        std::vector<double> m_none;
+};
+
+#endif
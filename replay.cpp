@@ -0,0 +1,96 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include "board.h"
+#include "boardpool.h"
+#include "movelog.h"
+#include "history.h"
+using namespace std;
+
+// Headless replayer: re-executes recorded move logs at engine speed and checks the board's
+// state hash after every move against the one recorded.
+//
+//   replay [--repeat n] log...
+//
+// Every log is decoded up front, so the timed part is the engine alone. The first move whose
+// hash differs ends that game's replay and is reported. A corpus of real sessions replayed
+// with --repeat doubles as a throughput benchmark on realistic move sequences.
+
+struct RecordedGame{
+    string log;
+    int number;
+    GameEntry game;
+    vector<MoveEntry> moves;
+};
+
+int main(int argc, char* argv[]){
+    int repeat = 1;
+    int first = 1;
+    if(argc > 2 && strcmp(argv[1], "--repeat") == 0){
+        repeat = max(1, atoi(argv[2]));
+        first = 3;
+    }
+    if(first >= argc){
+        cerr << "usage: " << argv[0] << " [--repeat n] log..." << endl;
+        return EXIT_FAILURE;
+    }
+
+    vector<RecordedGame> games;
+    size_t moves = 0;
+    for(int i = first; i < argc; i++){
+        MoveLogReader reader;
+        if(!reader.open(argv[i])){
+            cerr << reader.getError() << endl;
+            return EXIT_FAILURE;
+        }
+        GameEntry game;
+        MoveEntry move;
+        MoveAction kind;
+        int number = 0;
+        while(reader.next(game, move, kind)){
+            if(kind == ACTION_GAME) games.push_back(RecordedGame{argv[i], ++number, game, {}});
+            else games.back().moves.push_back(move);
+        }
+        if(!reader.getError().empty()){
+            cerr << argv[i] << ": " << reader.getError() << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    for(const RecordedGame& recorded : games){
+        moves += recorded.moves.size();
+    }
+
+    // boards are reused between games of the same size
+    BoardPool boards;
+    Board* board = nullptr;
+    History history;
+    int mismatches = 0;
+    double opened = 0;
+    auto start = chrono::steady_clock::now();
+    for(int pass = 0; pass < repeat; pass++){
+        for(const RecordedGame& recorded : games){
+            const GameEntry& game = recorded.game;
+            if(board) boards.release(board);
+            board = boards.acquire(game.rows, game.cols, game.bombs);
+            board->trackHistory(&history);
+            board->setSeed(game.seed);
+            for(size_t i = 0; i < recorded.moves.size(); i++){
+                if(replayMove(*board, recorded.moves[i])) continue;
+                if(pass == 0){
+                    cout << recorded.log << ": game " << recorded.number << " diverges at move " << i + 1 << endl;
+                    mismatches++;
+                }
+                break;
+            }
+            opened += double(game.rows) * game.cols - board->getBombs() - board->getUnopenedSafe();
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << games.size() << " games, " << moves << " moves, " << mismatches << " diverged" << endl;
+    cout << repeat * moves / seconds << " moves/s, " << opened / seconds << " cells opened/s" << endl;
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,477 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <charconv>
+#include <new>
+#include <vector>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "board.h"
+#include "history.h"
+#include "stats.h"
+using namespace std;
+
+// Game server: hosts one game per connection, for thousands of connections, on a single
+// epoll loop.
+//
+//   server [--port n | --unix path]
+//
+// Listens on 127.0.0.1:7878 by default. The protocol is one command per line:
+//
+//   new rows cols bombs seed    start a game; the first open is the first click
+//   o row col                   open
+//   f row col                   flag or unflag
+//   c row col                   chord
+//   u / r                       undo / redo
+//   show                        the board, as "board rows cols" and one line per row
+//   stats                       writes the hot-path stats (see stats.h), answered with
+//                               "stats path", or "error" in a build without them
+//
+// Every move is answered with "result state opened flags", e.g. "ok playing 52 3", where
+// result is ok, invalid, open, flagged, bomb or won, and a bad command with "error".
+//
+// Each loop iteration reads everything every ready connection has sent, plays all the complete
+// commands in it, and only then writes the replies, so a burst of moves costs one read and one
+// write per connection. A session's board and cells live in its own arena, which a new game of
+// the same size or smaller reuses without allocating. Boards are capped at MAX_SESSION_CELLS
+// cells and all arenas together at MAX_ARENA_BYTES; a `new` past either is answered "error".
+
+const int DEFAULT_PORT = 7878;
+const int MAX_EVENTS = 1024;
+const size_t READ_CHUNK = 1 << 16;
+// the longest command is a few dozen bytes; a session holding more than this without a newline
+// is dropped
+const size_t MAX_LINE = 4096;
+// the largest board a session may start, about 4 MB of arena
+const long long MAX_SESSION_CELLS = 1 << 22;
+// all sessions' arenas together; a new game that would pass it is refused
+const size_t MAX_ARENA_BYTES = size_t(1) << 30;
+
+// Bump allocator for one session. rewind() makes room for a whole game up front, so pointers
+// handed out stay valid until the next rewind.
+class Arena{
+    public:
+        Arena();
+        ~Arena();
+        void rewind(size_t capacity);
+        void* allocate(size_t bytes);
+        // Frees the block.
+        void release();
+        // Bytes rewind(capacity) leaves the arena holding.
+        size_t sizeFor(size_t capacity) const;
+        size_t getSize() const;
+    private:
+        Arena(const Arena&);
+        Arena& operator=(const Arena&);
+        char* m_block;
+        size_t m_size;
+        size_t m_used;
+};
+
+Arena::Arena()
+{
+    m_block = nullptr;
+    m_size = 0;
+    m_used = 0;
+}
+
+Arena::~Arena()
+{
+    free(m_block);
+}
+
+void Arena::rewind(size_t capacity)
+{
+    m_used = 0;
+    if(capacity <= m_size) return;
+    free(m_block);
+    m_block = static_cast<char*>(aligned_alloc(64, (capacity + 63) / 64 * 64));
+    if(!m_block){
+        m_size = 0;
+        throw bad_alloc();
+    }
+    m_size = capacity;
+}
+
+void Arena::release()
+{
+    free(m_block);
+    m_block = nullptr;
+    m_size = 0;
+    m_used = 0;
+}
+
+size_t Arena::sizeFor(size_t capacity) const
+{
+    return capacity <= m_size ? m_size : capacity;
+}
+
+size_t Arena::getSize() const
+{
+    return m_size;
+}
+
+void* Arena::allocate(size_t bytes)
+{
+    size_t start = (m_used + 63) / 64 * 64;
+    if(start + bytes > m_size) throw bad_alloc();
+    m_used = start + bytes;
+    return m_block + start;
+}
+
+struct Session{
+    int fd;
+    string in;
+    string out;
+    Arena arena;
+    Board* board;
+    History history;
+    bool writing;   // waiting for the socket to take the rest of `out`
+};
+
+class Server{
+    public:
+        Server(int listener);
+        ~Server();
+        void run();
+    private:
+        void accept();
+        void read(Session* session);
+        void execute(Session* session, const char* line, const char* end);
+        bool newGame(Session* session, long long rows, long long cols, long long bombs, long long seed);
+        void reply(Session* session, MoveResult result);
+        void flush(Session* session);
+        void close(Session* session);
+        int m_listener;
+        int m_epoll;
+        // held open so that, out of descriptors, one can be freed to accept and shed a connection
+        int m_spare;
+        // sessions by file descriptor
+        vector<Session*> m_sessions;
+        // sessions that got input this iteration, flushed once all of it is played
+        vector<Session*> m_ready;
+        // bytes held by every session's arena
+        size_t m_arenaBytes;
+        char m_chunk[READ_CHUNK];
+};
+
+Server::Server(int listener)
+{
+    m_listener = listener;
+    m_arenaBytes = 0;
+    m_spare = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    m_epoll = epoll_create1(0);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = listener;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, listener, &event);
+}
+
+Server::~Server()
+{
+    for(Session* session : m_sessions){
+        if(!session) continue;
+        close(session);
+        delete session;
+    }
+    ::close(m_epoll);
+    if(m_spare >= 0) ::close(m_spare);
+}
+
+void Server::run()
+{
+    epoll_event events[MAX_EVENTS];
+    while(true){
+        int count = epoll_wait(m_epoll, events, MAX_EVENTS, -1);
+        if(count < 0){
+            if(errno == EINTR) continue;
+            cerr << "epoll_wait: " << strerror(errno) << endl;
+            return;
+        }
+        for(int i = 0; i < count; i++){
+            int fd = events[i].data.fd;
+            if(fd == m_listener){
+                accept();
+                continue;
+            }
+            Session* session = m_sessions[fd];
+            if(!session) continue;
+            if(events[i].events & EPOLLOUT) flush(session);
+            if(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) read(session);
+        }
+        for(Session* session : m_ready){
+            if(session->fd < 0) delete session;
+            else flush(session);
+        }
+        m_ready.clear();
+    }
+}
+
+void Server::accept()
+{
+    while(true){
+        int fd = accept4(m_listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0 && (errno == EINTR || errno == ECONNABORTED)) continue;
+        // Out of descriptors the connection stays queued and the level-triggered listener
+        // would wake every epoll_wait, so it is accepted on the spare descriptor and closed.
+        if(fd < 0 && (errno == EMFILE || errno == ENFILE) && m_spare >= 0){
+            ::close(m_spare);
+            fd = accept4(m_listener, nullptr, nullptr, SOCK_CLOEXEC);
+            if(fd >= 0) ::close(fd);
+            m_spare = open("/dev/null", O_RDONLY | O_CLOEXEC);
+            if(fd >= 0) continue;
+        }
+        if(fd < 0) return;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        Session* session = new Session();
+        session->fd = fd;
+        session->board = nullptr;
+        session->writing = false;
+        if(m_sessions.size() <= size_t(fd)) m_sessions.resize(fd + 1, nullptr);
+        m_sessions[fd] = session;
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+// Reads all that is waiting and plays every complete line as each chunk arrives. The replies
+// are written after the iteration's other sessions have been read. A session whose unfinished
+// line passes MAX_LINE is closed.
+void Server::read(Session* session)
+{
+    bool closed = false;
+    while(!closed){
+        ssize_t got = ::read(session->fd, m_chunk, sizeof(m_chunk));
+        if(got > 0){
+            size_t start = 0, newline;
+            session->in.append(m_chunk, got);
+            while((newline = session->in.find('\n', start)) != string::npos){
+                execute(session, session->in.data() + start, session->in.data() + newline);
+                start = newline + 1;
+            }
+            session->in.erase(0, start);
+            closed = session->in.size() > MAX_LINE;
+            continue;
+        }
+        if(got < 0 && errno == EINTR) continue;
+        closed = got == 0 || errno != EAGAIN;
+        break;
+    }
+    if(closed){
+        close(session);
+        m_ready.push_back(session);
+    }
+    else if(!session->writing && !session->out.empty()) m_ready.push_back(session);
+}
+
+static bool nextNumber(const char*& position, const char* end, long long& value)
+{
+    while(position < end && *position == ' ') position++;
+    from_chars_result parsed = from_chars(position, end, value);
+    if(parsed.ec != errc()) return false;
+    position = parsed.ptr;
+    return true;
+}
+
+void Server::execute(Session* session, const char* line, const char* end)
+{
+    if(end > line && end[-1] == '\r') end--;
+    const char* word = line;
+    while(line < end && *line != ' ') line++;
+    string command(word, line);
+    long long rows, cols, bombs, seed;
+    Board* board = session->board;
+    if(command == "new"){
+        if(nextNumber(line, end, rows) && nextNumber(line, end, cols) && nextNumber(line, end, bombs) && nextNumber(line, end, seed)
+           && rows > 0 && cols > 0 && rows <= MAX_SESSION_CELLS && cols <= MAX_SESSION_CELLS && rows * cols <= MAX_SESSION_CELLS
+           && bombs >= 0 && bombs <= rows * cols && newGame(session, rows, cols, bombs, seed)){
+            session->out += "ok playing 0 0\n";
+        }
+        else session->out += "error\n";
+        return;
+    }
+    if(command == "stats"){
+        string path = statsPath();
+        session->out += STATS_ENABLED && writeStats(path) ? "stats " + path + "\n" : "error\n";
+        return;
+    }
+    if(!board){
+        session->out += "error\n";
+        return;
+    }
+    if(command == "u" || command == "r"){
+        bool done = command == "u" ? board->undo() : board->redo();
+        reply(session, done ? MOVE_OK : MOVE_INVALID);
+        return;
+    }
+    if(command == "show"){
+        char header[64];
+        session->out.append(header, snprintf(header, sizeof(header), "board %d %d\n", board->getRows(), board->getCols()));
+        for(int r = 0; r < board->getRows(); r++){
+            for(int c = 0; c < board->getCols(); c++){
+                const Cell& cell = board->getCell(r, c);
+                session->out += cell.getFlag() ? 'F' : cell.isOpened() ? cell.getValue() : '.';
+            }
+            session->out += '\n';
+        }
+        return;
+    }
+    long long row, col;
+    if(command.size() != 1 || !nextNumber(line, end, row) || !nextNumber(line, end, col)){
+        session->out += "error\n";
+        return;
+    }
+    MoveResult result = MOVE_INVALID;
+    if(!board->stillPlaying() || row < 0 || col < 0 || row >= board->getRows() || col >= board->getCols()) result = MOVE_INVALID;
+    else if(command == "o") result = board->getMinesPlaced() ? board->processMove(row, col) : board->handleFirstClick(row, col);
+    else if(command == "f") result = board->flagCell(row, col);
+    else if(command == "c") result = board->chordCell(row, col);
+    else{
+        session->out += "error\n";
+        return;
+    }
+    reply(session, result);
+}
+
+// The board and its cells are placed in the session's arena. False, leaving the current game
+// as it is, if growing the arena would take every arena past MAX_ARENA_BYTES.
+bool Server::newGame(Session* session, long long rows, long long cols, long long bombs, long long seed)
+{
+    size_t cells = Board::gridCells(rows, cols);
+    size_t capacity = sizeof(Board) + 64 + cells;
+    size_t size = session->arena.sizeFor(capacity);
+    if(m_arenaBytes - session->arena.getSize() + size > MAX_ARENA_BYTES) return false;
+    if(session->board){
+        session->board->trackHistory(nullptr);
+        session->board->~Board();
+    }
+    m_arenaBytes -= session->arena.getSize();
+    m_arenaBytes += size;
+    session->arena.rewind(capacity);
+    void* place = session->arena.allocate(sizeof(Board));
+    Cell* grid = static_cast<Cell*>(session->arena.allocate(cells));
+    session->board = new(place) Board(rows, cols, bombs, grid);
+    session->board->reset();
+    session->board->setSeed(seed);
+    session->board->trackHistory(&session->history);
+    return true;
+}
+
+void Server::reply(Session* session, MoveResult result)
+{
+    static const char* const RESULTS[] = {"ok", "invalid", "open", "flagged", "bomb", "won"};
+    static const char* const STATES[] = {"playing", "won", "lost"};
+    const Board& board = *session->board;
+    long opened = long(board.getRows()) * board.getCols() - board.getBombs() - board.getUnopenedSafe();
+    char line[64];
+    int length = snprintf(line, sizeof(line), "%s %s %ld %d\n", RESULTS[result], STATES[board.getState()], opened, board.getFlagCount());
+    session->out.append(line, length);
+}
+
+void Server::flush(Session* session)
+{
+    size_t done = 0;
+    while(done < session->out.size()){
+        // a peer gone since it sent the command must not raise SIGPIPE and end the server
+        ssize_t written = send(session->fd, session->out.data() + done, session->out.size() - done, MSG_NOSIGNAL);
+        if(written > 0){
+            done += written;
+            continue;
+        }
+        if(written < 0 && errno == EINTR) continue;
+        break;
+    }
+    session->out.erase(0, done);
+    // wait for the socket to drain before writing the rest
+    bool writing = !session->out.empty();
+    if(writing != session->writing){
+        epoll_event event = {};
+        event.events = writing ? EPOLLIN | EPOLLOUT : EPOLLIN;
+        event.data.fd = session->fd;
+        epoll_ctl(m_epoll, EPOLL_CTL_MOD, session->fd, &event);
+        session->writing = writing;
+    }
+}
+
+// Closes the connection and frees the game and its arena. The session itself is deleted by the caller.
+void Server::close(Session* session)
+{
+    if(session->fd < 0) return;
+    if(session->board){
+        session->board->trackHistory(nullptr);
+        session->board->~Board();
+        session->board = nullptr;
+    }
+    m_arenaBytes -= session->arena.getSize();
+    session->arena.release();
+    m_sessions[session->fd] = nullptr;
+    ::close(session->fd);
+    session->fd = -1;
+}
+
+// Lets the process hold as many connections as the hard limit allows.
+static void raiseFileLimit()
+{
+    rlimit limit;
+    if(getrlimit(RLIMIT_NOFILE, &limit) == 0){
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+int main(int argc, char* argv[]){
+    int port = DEFAULT_PORT;
+    const char* unixPath = nullptr;
+    for(int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if(arg == "--port" && i + 1 < argc) port = atoi(argv[++i]);
+        else if(arg == "--unix" && i + 1 < argc) unixPath = argv[++i];
+        else{
+            cerr << "usage: " << argv[0] << " [--port n | --unix path]" << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    raiseFileLimit();
+
+    int listener;
+    if(unixPath){
+        listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, unixPath, sizeof(address.sun_path) - 1);
+        unlink(unixPath);
+        if(bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0){
+            cerr << "cannot listen on " << unixPath << ": " << strerror(errno) << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    else{
+        listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if(bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0){
+            cerr << "cannot listen on port " << port << ": " << strerror(errno) << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    Server server(listener);
+    server.run();
+    close(listener);
+    return EXIT_FAILURE;
+}
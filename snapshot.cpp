@@ -0,0 +1,177 @@
+#include "snapshot.h"
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+Snapshot::Snapshot()
+{
+    m_board = nullptr;
+    m_mapping = nullptr;
+    m_mappedBytes = 0;
+}
+
+Snapshot::~Snapshot()
+{
+    unload();
+}
+
+bool Snapshot::fail(const string& what)
+{
+    m_error = what;
+    if(errno) m_error += string(": ") + strerror(errno);
+    return false;
+}
+
+void Snapshot::unload()
+{
+    delete m_board;
+    m_board = nullptr;
+    if(m_mapping) munmap(m_mapping, m_mappedBytes);
+    m_mapping = nullptr;
+    m_mappedBytes = 0;
+}
+
+// Writes all of `bytes`, going round again after short writes and signals.
+static bool writeAll(int fd, const char* bytes, size_t size)
+{
+    while(size > 0){
+        ssize_t written = write(fd, bytes, size);
+        if(written < 0){
+            if(errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool Snapshot::save(const Board& board, const string& path)
+{
+    char header[SNAPSHOT_HEADER_BYTES] = {0};
+    SnapshotHeader fields;
+    memset(&fields, 0, sizeof(fields));
+    memcpy(fields.magic, "MSWPSNAP", sizeof(fields.magic));
+    fields.version = SNAPSHOT_VERSION;
+    fields.byteOrder = SNAPSHOT_BYTE_ORDER;
+    fields.headerBytes = SNAPSHOT_HEADER_BYTES;
+    fields.cellBytes = sizeof(Cell);
+    fields.rows = board.m_rows;
+    fields.cols = board.m_cols;
+    fields.bombs = board.m_bombs;
+    fields.flags = board.bombsFlagged;
+    fields.unopenedSafe = board.m_unopenedSafe;
+    fields.minesPlaced = board.m_minesPlaced;
+    fields.state = board.m_state;
+    fields.seed = board.m_seed;
+    fields.stateHash = board.m_stateHash;
+    memcpy(header, &fields, sizeof(fields));
+
+    errno = 0;
+    string temporary = path + ".tmp";
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) return fail("cannot create " + temporary);
+    size_t cells = Board::gridCells(board.m_rows, board.m_cols) * sizeof(Cell);
+    bool written = writeAll(fd, header, sizeof(header))
+                && writeAll(fd, reinterpret_cast<const char*>(board.m_cells), cells);
+    if(close(fd) != 0) written = false;
+    if(!written){
+        fail("cannot write " + temporary);
+        unlink(temporary.c_str());
+        return false;
+    }
+    if(rename(temporary.c_str(), path.c_str()) != 0){
+        fail("cannot replace " + path);
+        unlink(temporary.c_str());
+        return false;
+    }
+    m_error.clear();
+    return true;
+}
+
+bool Snapshot::load(const string& path)
+{
+    unload();
+    errno = 0;
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) return fail("cannot open " + path);
+    struct stat info;
+    if(fstat(fd, &info) != 0){
+        close(fd);
+        return fail("cannot stat " + path);
+    }
+    if(info.st_size < off_t(SNAPSHOT_HEADER_BYTES)){
+        close(fd);
+        return fail(path + " is too short for a snapshot");
+    }
+    // copy-on-write, so the board can be played without touching the file
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED) return fail("cannot map " + path);
+    m_mapping = mapping;
+    m_mappedBytes = info.st_size;
+    errno = 0;
+
+    SnapshotHeader fields;
+    memcpy(&fields, mapping, sizeof(fields));
+    if(memcmp(fields.magic, "MSWPSNAP", sizeof(fields.magic)) != 0){
+        unload();
+        return fail(path + " is not a snapshot");
+    }
+    if(fields.version != SNAPSHOT_VERSION){
+        unload();
+        return fail(path + " is snapshot version " + to_string(fields.version) + ", expected " + to_string(SNAPSHOT_VERSION));
+    }
+    long long cells = (long long)fields.rows * fields.cols;
+    long long gridCells = (long long)(fields.rows + 2LL) * (fields.cols + 2LL);
+    bool valid = fields.byteOrder == SNAPSHOT_BYTE_ORDER
+              && fields.headerBytes == SNAPSHOT_HEADER_BYTES
+              && fields.cellBytes == sizeof(Cell)
+              && fields.rows > 0 && fields.cols > 0 && gridCells <= INT_MAX
+              && fields.bombs >= 0 && fields.bombs <= cells
+              && fields.unopenedSafe >= 0 && fields.unopenedSafe <= cells - fields.bombs
+              && fields.flags >= 0 && fields.flags <= cells
+              && fields.state <= GAME_LOST;
+    if(!valid){
+        unload();
+        return fail(path + " has a damaged header");
+    }
+    if((long long)m_mappedBytes != (long long)SNAPSHOT_HEADER_BYTES + gridCells){
+        unload();
+        return fail(path + " is not the size its header gives");
+    }
+
+    Cell* grid = reinterpret_cast<Cell*>(static_cast<char*>(mapping) + SNAPSHOT_HEADER_BYTES);
+    m_board = new Board(fields.rows, fields.cols, fields.bombs, grid);
+    // fills rely on the ring to stop, so a file with a damaged one is refused. The ring is only
+    // read: writing it would copy every page of the private mapping, since each row has a side
+    // sentinel
+    if(!m_board->sentinelsIntact()){
+        unload();
+        return fail(path + " has a damaged sentinel ring");
+    }
+    m_board->bombsFlagged = fields.flags;
+    m_board->m_unopenedSafe = fields.unopenedSafe;
+    m_board->m_minesPlaced = fields.minesPlaced;
+    m_board->m_state = GameState(fields.state);
+    m_board->m_seed = fields.seed;
+    m_board->m_stateHash = fields.stateHash;
+    m_error.clear();
+    return true;
+}
+
+Board* Snapshot::getBoard()
+{
+    return m_board;
+}
+
+const string& Snapshot::getError() const
+{
+    return m_error;
+}
@@ -0,0 +1,69 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "board.h"
+
+// Binary board checkpoints. A snapshot file is one 4096-byte header page followed by the raw
+// cell bytes of the board's grid, row by row with its ring of sentinels (see Board::gridCells).
+// Each byte already holds a cell's mine, count, opened and flag bits, so the cells are written
+// as they are in memory and loading maps them back in: a huge board is playable straight away,
+// without a parse step, and pages are read in as they are touched. Loading only reads the
+// ring, and refuses a file where it is damaged.
+//
+// The header is a SnapshotHeader: a magic, the format version, the dimensions, the counters,
+// the seed and the state hash. Integers are in the writer's byte order, which a marker field
+// lets the loader check. Files from another format version are refused rather than guessed at.
+struct SnapshotHeader{
+    char magic[8];              // "MSWPSNAP"
+    uint32_t version;
+    uint32_t byteOrder;         // SNAPSHOT_BYTE_ORDER as the writer saw it
+    uint32_t headerBytes;       // where the cells start, SNAPSHOT_HEADER_BYTES
+    uint32_t cellBytes;         // sizeof(Cell)
+    int32_t rows;
+    int32_t cols;
+    int32_t bombs;
+    int32_t flags;
+    int32_t unopenedSafe;
+    uint8_t minesPlaced;
+    uint8_t state;              // a GameState
+    uint8_t padding[2];
+    uint64_t seed;
+    uint64_t stateHash;         // added in version 2, with flags hashed by position since version 3
+};
+
+// version 4 stores the sentinel ring
+const uint32_t SNAPSHOT_VERSION = 4;
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+const size_t SNAPSHOT_HEADER_BYTES = 4096;
+
+static_assert(sizeof(SnapshotHeader) <= SNAPSHOT_HEADER_BYTES, "the header fits its page");
+
+class Snapshot{
+    public:
+        Snapshot();
+        ~Snapshot();
+        // Writes `board` to a temporary file next to `path` and renames it into place, so a
+        // failed save leaves the previous snapshot intact.
+        bool save(const Board& board, const std::string& path);
+        // Maps `path` and builds a board on the mapping, replacing any board loaded before.
+        // The mapping is private: moves copy the pages they touch and never reach the file.
+        bool load(const std::string& path);
+        // The loaded board, or null. It lives as long as the snapshot, or until the next load.
+        Board* getBoard();
+        // Why the last save or load failed.
+        const std::string& getError() const;
+    private:
+        Snapshot(const Snapshot&);
+        Snapshot& operator=(const Snapshot&);
+        bool fail(const std::string& what);
+        void unload();
+        Board* m_board;
+        void* m_mapping;
+        size_t m_mappedBytes;
+        std::string m_error;
+};
+
+#endif
@@ -0,0 +1,162 @@
+#include "solver.h"
+using namespace std;
+
+// Frame layout: bit (r * 7 + c) for r, c in 0..6. A constraint's own 3x3 block sits with its
+// top-left corner at (2, 2); a neighbour dr rows and dc columns away sits at (2 + dr, 2 + dc).
+const int FRAME = 7;
+const int ORIGIN = 2 * FRAME + 2;
+
+Solver::Solver()
+{
+    for(unsigned mask = 0; mask < 512; mask++){
+        m_spread[mask] = 0;
+        for(int bit = 0; bit < 9; bit++){
+            if(mask & (1u << bit)) m_spread[mask] |= uint64_t(1) << ((bit / 3) * FRAME + bit % 3);
+        }
+    }
+    m_safe = nullptr;
+    m_mines = nullptr;
+    m_rows = 0;
+    m_cols = 0;
+    m_words = 0;
+    m_closed = 0;
+}
+
+bool Solver::solve(const Board& board, vector<int>& safe, vector<int>& mines)
+{
+    size_t found = safe.size() + mines.size();
+    m_safe = &safe;
+    m_mines = &mines;
+    buildConstraints(board);
+
+    // the global count settles the whole board once the remaining bombs are 0 or fill every closed cell
+    int remaining = board.getBombs() - board.getFlagCount();
+    if(remaining == 0 || remaining == m_closed){
+        for(int r = 0; r < m_rows; r++){
+            for(int c = 0; c < m_cols; c++){
+                const Cell& cell = board.getCell(r, c);
+                if(!cell.isOpened() && !cell.getFlag()) mark(r * m_cols + c, remaining != 0);
+            }
+        }
+        return safe.size() + mines.size() > found;
+    }
+
+    for(const Constraint& a : m_constraints){
+        int closed = __builtin_popcount(a.mask);
+        if(a.mines == 0) emit(m_spread[a.mask] << ORIGIN, a, false);
+        else if(a.mines == closed) emit(m_spread[a.mask] << ORIGIN, a, true);
+
+        // each pair is visited once, from the constraint that comes first in row-major order
+        for(int dr = 0; dr <= 2; dr++){
+            int r = a.row + dr;
+            if(r >= m_rows) break;
+            for(int dc = -2; dc <= 2; dc++){
+                if(dr == 0 && dc <= 0) continue;
+                int c = a.col + dc;
+                if(c < 0 || c >= m_cols) continue;
+                int other = m_constraintAt[r * m_cols + c];
+                if(other < 0) continue;
+                compare(a, m_constraints[other], dr, dc);
+            }
+        }
+    }
+    return safe.size() + mines.size() > found;
+}
+
+// Closed and flagged cells are first packed into row bitboards with a zero border, so a number's
+// 3x3 neighbourhood is three 3-bit extracts instead of nine bounds-checked cell reads.
+void Solver::buildConstraints(const Board& board)
+{
+    m_rows = board.getRows();
+    m_cols = board.getCols();
+    m_words = (m_cols + 2 + 63) / 64 + 1;
+    m_closedBits.assign((m_rows + 2) * m_words, 0);
+    m_flagBits.assign((m_rows + 2) * m_words, 0);
+    m_closed = 0;
+    m_constraints.clear();
+    m_constraintAt.assign(m_rows * m_cols, -1);
+    m_marked.assign(m_rows * m_cols, 0);
+    for(int r = 0; r < m_rows; r++){
+        uint64_t* closedRow = &m_closedBits[(r + 1) * m_words];
+        uint64_t* flagRow = &m_flagBits[(r + 1) * m_words];
+        for(int c = 0; c < m_cols; c++){
+            const Cell& cell = board.getCell(r, c);
+            if(cell.isOpened()) continue;
+            if(cell.getFlag()) flagRow[(c + 1) >> 6] |= uint64_t(1) << ((c + 1) & 63);
+            else{
+                closedRow[(c + 1) >> 6] |= uint64_t(1) << ((c + 1) & 63);
+                m_closed++;
+            }
+        }
+    }
+    for(int r = 0; r < m_rows; r++){
+        for(int c = 0; c < m_cols; c++){
+            const Cell& cell = board.getCell(r, c);
+            if(!cell.isOpened() || cell.getCount() == 0) continue;
+            unsigned mask = neighbourhood(m_closedBits, r, c);
+            if(mask == 0) continue;
+            Constraint constraint;
+            constraint.row = r;
+            constraint.col = c;
+            constraint.mines = cell.getCount() - __builtin_popcount(neighbourhood(m_flagBits, r, c));
+            constraint.mask = mask;
+            m_constraintAt[r * m_cols + c] = m_constraints.size();
+            m_constraints.push_back(constraint);
+        }
+    }
+}
+
+// The 3x3 block around (row, col) as 9 bits, row by row, read from a bordered row bitboard.
+unsigned Solver::neighbourhood(const vector<uint64_t>& bits, int row, int col) const
+{
+    unsigned mask = 0;
+    int word = col >> 6;
+    int shift = col & 63;
+    for(int r = 0; r < 3; r++){
+        const uint64_t* line = &bits[(row + r) * m_words + word];
+        uint64_t value = line[0] >> shift;
+        if(shift > 61) value |= line[1] << (64 - shift);
+        mask |= unsigned(value & 7) << (r * 3);
+    }
+    return mask;
+}
+
+// B holds at least b.mines - a.mines bombs outside A, since at most a.mines can sit in the
+// overlap. When that equals the number of cells of B outside A, those cells are all bombs and
+// the overlap holds exactly a.mines, so A's cells outside B are all safe. Running the rule both
+// ways also covers the plain subset case (equal counts make the difference safe).
+void Solver::compare(const Constraint& a, const Constraint& b, int dr, int dc)
+{
+    uint64_t frameA = m_spread[a.mask] << ORIGIN;
+    uint64_t frameB = m_spread[b.mask] << ((2 + dr) * FRAME + 2 + dc);
+    if((frameA & frameB) == 0) return;
+    uint64_t onlyA = frameA & ~frameB;
+    uint64_t onlyB = frameB & ~frameA;
+    if(b.mines - a.mines == __builtin_popcountll(onlyB)){
+        emit(onlyB, a, true);
+        emit(onlyA, a, false);
+    }
+    if(a.mines - b.mines == __builtin_popcountll(onlyA)){
+        emit(onlyA, a, true);
+        emit(onlyB, a, false);
+    }
+}
+
+void Solver::emit(uint64_t frame, const Constraint& origin, bool mine)
+{
+    while(frame){
+        int bit = __builtin_ctzll(frame);
+        frame &= frame - 1;
+        int r = origin.row + bit / FRAME - 3;
+        int c = origin.col + bit % FRAME - 3;
+        mark(r * m_cols + c, mine);
+    }
+}
+
+void Solver::mark(int cell, bool mine)
+{
+    if(m_marked[cell]) return;
+    m_marked[cell] = 1;
+    if(mine) m_mines->push_back(cell);
+    else m_safe->push_back(cell);
+}
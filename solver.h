@@ -0,0 +1,45 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <cstdint>
+#include <vector>
+#include "board.h"
+
+// Deterministic deduction over what a player can see: opened numbers, flags and closed cells.
+// It never looks at where the bombs are. Each number next to closed cells becomes a
+// constraint "these closed neighbours hold this many bombs", kept as a 3x3 bitmask. To compare
+// two constraints up to two cells apart, both masks are placed into one 7x7 frame held in a
+// uint64_t, so subset and superset checks are a few 64-bit ANDs and popcounts.
+class Solver{
+    public:
+        Solver();
+        // One deduction round. Appends cells (row * cols + col) that are certainly safe to
+        // `safe` and certainly bombs to `mines`; returns false when nothing is certain.
+        bool solve(const Board& board, std::vector<int>& safe, std::vector<int>& mines);
+    private:
+        struct Constraint{
+            int row;
+            int col;
+            int mines;
+            unsigned mask;
+        };
+        void buildConstraints(const Board& board);
+        unsigned neighbourhood(const std::vector<uint64_t>& bits, int row, int col) const;
+        void compare(const Constraint& a, const Constraint& b, int dr, int dc);
+        void emit(uint64_t frame, const Constraint& origin, bool mine);
+        void mark(int cell, bool mine);
+        uint64_t m_spread[512];
+        std::vector<Constraint> m_constraints;
+        std::vector<int> m_constraintAt;
+        std::vector<unsigned char> m_marked;
+        std::vector<uint64_t> m_closedBits;
+        std::vector<uint64_t> m_flagBits;
+        std::vector<int>* m_safe;
+        std::vector<int>* m_mines;
+        int m_rows;
+        int m_cols;
+        int m_words;
+        int m_closed;
+};
+
+#endif
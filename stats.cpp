@@ -0,0 +1,117 @@
+#include "stats.h"
+#include <cstdio>
+#include <cstdlib>
+#ifdef MINESWEEPER_STATS
+#include <mutex>
+#include <vector>
+#endif
+using namespace std;
+
+string statsPath()
+{
+    const char* path = getenv("MINESWEEPER_STATS_FILE");
+    return path && *path ? path : "minesweeper-stats.json";
+}
+
+#ifdef MINESWEEPER_STATS
+
+struct StatInfo{
+    const char* name;
+    const char* unit;
+};
+
+static const StatInfo STAT_INFO[STAT_COUNT] = {
+    {"firstClick", "ns"},
+    {"processMove", "ns"},
+    {"floodFill", "ns"},
+    {"fillCells", "cells"},
+    {"fillStack", "seeds"},
+    {"winCheck", "ns"},
+    {"frameEvents", "ns"},
+    {"frameBoard", "ns"},
+    {"frameHud", "ns"},
+    {"framePresent", "ns"},
+};
+
+thread_local ThreadStats* t_threadStats = nullptr;
+
+// Every thread's histograms, never freed. The lock is only taken when a thread registers and
+// when stats are written.
+static mutex s_threadsLock;
+static vector<ThreadStats*> s_threads;
+
+ThreadStats* registerStatsThread()
+{
+    ThreadStats* stats = new ThreadStats();
+    lock_guard<mutex> lock(s_threadsLock);
+    stats->thread = s_threads.size();
+    s_threads.push_back(stats);
+    t_threadStats = stats;
+    return stats;
+}
+
+// The upper end of the bucket holding the sample at fraction p of the way up, capped at the
+// largest sample.
+static uint64_t percentile(const uint64_t* buckets, uint64_t count, uint64_t max, double p)
+{
+    uint64_t rank = uint64_t(p * (count - 1)) + 1;
+    uint64_t seen = 0;
+    for(int b = 0; b < STAT_BUCKETS; b++){
+        seen += buckets[b];
+        if(seen < rank) continue;
+        uint64_t top = b == 0 ? 0 : b == 64 ? UINT64_MAX : (uint64_t(1) << b) - 1;
+        return top < max ? top : max;
+    }
+    return max;
+}
+
+bool writeStats(const string& path)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if(!file) return false;
+    lock_guard<mutex> lock(s_threadsLock);
+    fprintf(file, "{\n  \"threads\": [");
+    for(size_t t = 0; t < s_threads.size(); t++){
+        fprintf(file, "%s\n    {\"thread\": %d, \"stats\": [", t ? "," : "", s_threads[t]->thread);
+        bool first = true;
+        for(int s = 0; s < STAT_COUNT; s++){
+            const StatHistogram& histogram = s_threads[t]->histograms[s];
+            uint64_t buckets[STAT_BUCKETS];
+            for(int b = 0; b < STAT_BUCKETS; b++){
+                buckets[b] = histogram.buckets[b].load(memory_order_relaxed);
+            }
+            uint64_t count = histogram.count.load(memory_order_relaxed);
+            uint64_t sum = histogram.sum.load(memory_order_relaxed);
+            uint64_t max = histogram.max.load(memory_order_relaxed);
+            if(count == 0) continue;
+            fprintf(file, "%s\n      {\"name\": \"%s\", \"unit\": \"%s\", \"count\": %llu, \"mean\": %.1f, "
+                "\"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu, \"buckets\": {",
+                first ? "" : ",", STAT_INFO[s].name, STAT_INFO[s].unit, (unsigned long long)count, double(sum) / count,
+                (unsigned long long)percentile(buckets, count, max, 0.5), (unsigned long long)percentile(buckets, count, max, 0.9),
+                (unsigned long long)percentile(buckets, count, max, 0.99), (unsigned long long)percentile(buckets, count, max, 0.999),
+                (unsigned long long)max);
+            first = false;
+            // keyed by the bucket's lowest value
+            bool firstBucket = true;
+            for(int b = 0; b < STAT_BUCKETS; b++){
+                if(buckets[b] == 0) continue;
+                unsigned long long low = b == 0 ? 0 : 1ULL << (b - 1);
+                fprintf(file, "%s\"%llu\": %llu", firstBucket ? "" : ", ", low, (unsigned long long)buckets[b]);
+                firstBucket = false;
+            }
+            fprintf(file, "}}");
+        }
+        fprintf(file, "\n    ]}");
+    }
+    fprintf(file, "\n  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+#else
+
+bool writeStats(const string&)
+{
+    return false;
+}
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef STATS_H
+#define STATS_H
+
+// Hot-path instrumentation. Built with -DMINESWEEPER_STATS, the engine and the frontends time
+// moves, fills and frame phases into per-thread histograms that writeStats() dumps as JSON.
+// Without it STAT_TIME and STAT_RECORD expand to nothing and cost nothing. Every translation
+// unit of a program has to be built the same way, since Board's inline fill changes with it.
+
+#include <cstdint>
+#include <string>
+#ifdef MINESWEEPER_STATS
+#include <atomic>
+#include <chrono>
+#endif
+
+enum Stat{
+    STAT_FIRST_CLICK,   // handleFirstClick, ns
+    STAT_PROCESS_MOVE,  // processMove, ns
+    STAT_FLOOD_FILL,    // one fill that spreads, ns
+    STAT_FILL_CELLS,    // cells that fill opened
+    STAT_FILL_STACK,    // its seed stack's high-water mark
+    STAT_WIN_CHECK,     // stillPlaying, which every frontend asks after a move, or checkGameStatus, ns
+    STAT_FRAME_EVENTS,  // SDL: handling one wake-up's events, ns
+    STAT_FRAME_BOARD,   // SDL: drawing the view or the changed cells, ns
+    STAT_FRAME_HUD,     // SDL: drawing the flag count or the timer, ns
+    STAT_FRAME_PRESENT, // SDL: copying the canvas and presenting, ns
+    STAT_COUNT
+};
+
+#ifdef MINESWEEPER_STATS
+const bool STATS_ENABLED = true;
+
+// Bucket 0 counts zeros and bucket b > 0 the values in [2^(b-1), 2^b).
+const int STAT_BUCKETS = 65;
+
+// Written by its own thread only, so an update is a relaxed load and store with no locked
+// instruction; writeStats reads it from another thread and may see a sample half added.
+struct StatHistogram{
+    std::atomic<uint64_t> buckets[STAT_BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+};
+
+struct ThreadStats{
+    StatHistogram histograms[STAT_COUNT];
+    int thread;     // in the order threads first recorded
+};
+
+// This thread's histograms, registered on its first sample. They outlive the thread, so a
+// dump still has what finished workers recorded.
+extern thread_local ThreadStats* t_threadStats;
+ThreadStats* registerStatsThread();
+
+inline void statAdd(std::atomic<uint64_t>& counter, uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+inline void recordStat(Stat stat, uint64_t value)
+{
+    ThreadStats* stats = t_threadStats ? t_threadStats : registerStatsThread();
+    StatHistogram& histogram = stats->histograms[stat];
+    int bucket = value == 0 ? 0 : 64 - __builtin_clzll(value);
+    statAdd(histogram.buckets[bucket], 1);
+    statAdd(histogram.count, 1);
+    statAdd(histogram.sum, value);
+    if(value > histogram.max.load(std::memory_order_relaxed)) histogram.max.store(value, std::memory_order_relaxed);
+}
+
+// Records the steady_clock nanoseconds from construction to the end of the scope.
+class StatTimer{
+    public:
+        StatTimer(Stat stat) : m_stat(stat), m_start(std::chrono::steady_clock::now()) {}
+        ~StatTimer()
+        {
+            recordStat(m_stat, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count());
+        }
+    private:
+        StatTimer(const StatTimer&);
+        StatTimer& operator=(const StatTimer&);
+        Stat m_stat;
+        std::chrono::steady_clock::time_point m_start;
+};
+
+#define STAT_JOIN2(a, b) a##b
+#define STAT_JOIN(a, b) STAT_JOIN2(a, b)
+#define STAT_TIME(stat) StatTimer STAT_JOIN(statTimer, __LINE__)(stat)
+#define STAT_RECORD(stat, value) recordStat(stat, value)
+#else
+const bool STATS_ENABLED = false;
+#define STAT_TIME(stat) do{}while(0)
+#define STAT_RECORD(stat, value) do{}while(0)
+#endif
+
+// Where the frontends dump: $MINESWEEPER_STATS_FILE, or minesweeper-stats.json.
+std::string statsPath();
+// Writes every thread's histograms to `path` as JSON: per stat its count, mean, max and
+// percentiles read off the buckets (so within a factor of two), and the non-empty buckets.
+// False, having written nothing, if the file cannot be written or STATS_ENABLED is false.
+bool writeStats(const std::string& path);
+
+#endif
@@ -0,0 +1,218 @@
+#include "terminalBatch.h"
+#include <iostream>
+#include <charconv>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include "board.h"
+#include "boardpool.h"
+#include "history.h"
+#include "terminalView.h"
+using namespace std;
+
+// output is written once this much has built up
+const size_t OUTPUT_BLOCK = 1 << 16;
+
+// Splits the stream into tokens, skipping whitespace and # comments, and keeps the line
+// number for error messages.
+class BatchTokens{
+    public:
+        BatchTokens(const string& text);
+        // The next token, or false at the end of the stream.
+        bool next(const char*& begin, const char*& end);
+        bool number(long long& value);
+        int getLine() const;
+    private:
+        const char* m_position;
+        const char* m_end;
+        int m_line;
+};
+
+BatchTokens::BatchTokens(const string& text)
+{
+    m_position = text.data();
+    m_end = text.data() + text.size();
+    m_line = 1;
+}
+
+bool BatchTokens::next(const char*& begin, const char*& end)
+{
+    while(m_position < m_end){
+        char c = *m_position;
+        if(c == '\n') m_line++;
+        if(c == '#'){
+            while(m_position < m_end && *m_position != '\n') m_position++;
+        }
+        else if(c == ' ' || c == '\t' || c == '\r' || c == '\n') m_position++;
+        else break;
+    }
+    if(m_position == m_end) return false;
+    begin = m_position;
+    while(m_position < m_end && *m_position != ' ' && *m_position != '\t' && *m_position != '\r' && *m_position != '\n' && *m_position != '#'){
+        m_position++;
+    }
+    end = m_position;
+    return true;
+}
+
+bool BatchTokens::number(long long& value)
+{
+    const char* begin;
+    const char* end;
+    if(!next(begin, end)) return false;
+    from_chars_result parsed = from_chars(begin, end, value);
+    return parsed.ec == errc() && parsed.ptr == end;
+}
+
+int BatchTokens::getLine() const
+{
+    return m_line;
+}
+
+static bool readAll(int fd, string& text)
+{
+    char chunk[1 << 16];
+    ssize_t got;
+    while((got = read(fd, chunk, sizeof(chunk))) != 0){
+        if(got < 0){
+            if(errno == EINTR) continue;
+            return false;
+        }
+        text.append(chunk, got);
+    }
+    return true;
+}
+
+static void writeOut(string& out)
+{
+    size_t done = 0;
+    while(done < out.size()){
+        ssize_t written = write(1, out.data() + done, out.size() - done);
+        if(written < 0){
+            if(errno == EINTR) continue;
+            break;
+        }
+        done += written;
+    }
+    out.clear();
+}
+
+// One line of results for the game so far.
+static void appendResults(string& out, const Board& board, long game, long moves, long rejected, bool final)
+{
+    const char* state = board.getState() == GAME_WON ? "won" : board.getState() == GAME_LOST ? "lost" : "playing";
+    long opened = long(board.getRows()) * board.getCols() - board.getBombs() - board.getUnopenedSafe();
+    char line[256];
+    int length;
+    if(final) length = snprintf(line, sizeof(line), "game %ld: %s after %ld moves", game, state, moves);
+    else length = snprintf(line, sizeof(line), "game %ld move %ld: %s", game, moves, state);
+    length += snprintf(line + length, sizeof(line) - length, ", %ld opened, %d flags, %ld rejected, hash %016llx\n",
+        opened, board.getFlagCount(), rejected, (unsigned long long)board.getStateHash());
+    out.append(line, length);
+}
+
+bool runBatch(int fd, int every, bool show, MoveLogWriter& log)
+{
+    string text;
+    if(!readAll(fd, text)){
+        cerr << "cannot read the move stream" << endl;
+        return false;
+    }
+    BatchTokens tokens(text);
+    string out;
+    // games alternating between a few sizes each keep their board
+    BoardPool boards;
+    Board* board = nullptr;
+    History history;
+    TerminalRenderer renderer(1, 0);
+    long game = 0, moves = 0, rejected = 0, totalMoves = 0;
+    const char* begin;
+    const char* end;
+    bool valid = true;
+    auto start = chrono::steady_clock::now();
+
+    // finishes the current game's output
+    auto finishGame = [&](){
+        if(!board) return;
+        appendResults(out, *board, game, moves, rejected, true);
+        if(show){
+            writeOut(out);
+            renderer.invalidate();
+            renderer.draw(*board, !board->stillPlaying());
+        }
+        totalMoves += moves;
+    };
+
+    while(valid && tokens.next(begin, end)){
+        string_view word(begin, end - begin);
+        if(word == "game"){
+            long long rows, cols, bombs, seed;
+            if(!tokens.number(rows) || !tokens.number(cols) || !tokens.number(bombs) || !tokens.number(seed)
+               || rows < 1 || cols < 1 || (rows + 2) * (cols + 2) > 1000000000LL || bombs < 0 || bombs > rows * cols){
+                valid = false;
+                break;
+            }
+            finishGame();
+            if(board) boards.release(board);
+            board = boards.acquire(rows, cols, bombs);
+            board->trackHistory(&history);
+            board->setSeed(seed);
+            log.beginGame();
+            game++;
+            moves = 0;
+            rejected = 0;
+            continue;
+        }
+        if(!board || word.size() != 1){
+            valid = false;
+            break;
+        }
+        char action = word[0];
+        MoveResult result = MOVE_OK;
+        if(action == 'u' || action == 'r'){
+            bool done = action == 'u' ? board->undo() : board->redo();
+            if(done) log.record(*board, action == 'u' ? ACTION_UNDO : ACTION_REDO, 0, 0);
+            else result = MOVE_INVALID;
+        }
+        else{
+            long long row, col;
+            if((action != 'o' && action != 'f' && action != 'c') || !tokens.number(row) || !tokens.number(col)){
+                valid = false;
+                break;
+            }
+            if(!board->stillPlaying() || row < 0 || col < 0 || row >= board->getRows() || col >= board->getCols()) result = MOVE_INVALID;
+            else if(action == 'o' && !board->getMinesPlaced()){
+                result = board->handleFirstClick(row, col);
+                log.record(*board, ACTION_FIRST_CLICK, row, col);
+            }
+            else if(action == 'o'){
+                result = board->processMove(row, col);
+                log.record(*board, ACTION_OPEN, row, col);
+            }
+            else if(action == 'f'){
+                result = board->flagCell(row, col);
+                log.record(*board, ACTION_FLAG, row, col);
+            }
+            else{
+                result = board->chordCell(row, col);
+                log.record(*board, ACTION_CHORD, row, col);
+            }
+        }
+        moves++;
+        if(result == MOVE_INVALID || result == MOVE_ALREADY_OPEN || result == MOVE_FLAGGED) rejected++;
+        if(every > 0 && moves % every == 0) appendResults(out, *board, game, moves, rejected, false);
+        if(out.size() >= OUTPUT_BLOCK) writeOut(out);
+    }
+    if(valid) finishGame();
+    writeOut(out);
+    if(!valid){
+        cerr << "malformed move stream at line " << tokens.getLine() << endl;
+        return false;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr << game << " games, " << totalMoves << " moves in " << seconds << " s (" << totalMoves / seconds << " moves/s)" << endl;
+    return true;
+}
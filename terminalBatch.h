@@ -0,0 +1,22 @@
+#ifndef TERMINALBATCH_H
+#define TERMINALBATCH_H
+
+#include "movelog.h"
+
+// Batch mode for the terminal executable: plays scripted games from a move stream with no
+// prompts and prints only results. The stream is whitespace separated, with # comments:
+//
+//   game rows cols bombs seed    starts a game; its first open is the first click
+//   o row col                    open
+//   f row col                    flag or unflag
+//   c row col                    chord: open around a number with all its flags placed
+//   u, r                         undo, redo
+//
+// Moves on a finished game are rejected, except undo and redo. Each game ends with one line
+// of results, and with `every` > 0 one is also printed after every `every` moves; `show` adds
+// the final board. The whole stream is read from `fd` before play starts and output is written
+// in large blocks, so a run is bound by the engine. Moves also go to `log` when it is open.
+// Returns false, after saying why on stderr, if the stream is malformed.
+bool runBatch(int fd, int every, bool show, MoveLogWriter& log);
+
+#endif
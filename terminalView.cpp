@@ -0,0 +1,237 @@
+#include "terminalView.h"
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <sys/ioctl.h>
+#include <unistd.h>
+using namespace std;
+
+// colour sequences are compared by address, so each lives in exactly one array
+static const char reset[] = "\033[0m";
+static const char colorOne[] = "\033[34m";
+static const char colorTwo[] = "\033[32m";
+static const char colorThree[] = "\033[31m";
+static const char colorFour[] = "\033[104m";
+static const char colorFive[] = "\033[101m";
+static const char colorSix[] = "\033[46m";
+static const char colorSeven[] = "\033[30m";
+static const char colorEight[] = "\033[90m";
+
+const int PROMPT_LINES = 4;
+
+static const char* colourOf(char value)
+{
+    switch(value){
+        case 'U': return colorEight;
+        case 'X': return colorFive;
+        case 'F': return colorThree;
+        case '1': return colorOne;
+        case '2': return colorTwo;
+        case '3': return colorThree;
+        case '4': return colorFour;
+        case '5': return colorFive;
+        case '6': return colorSix;
+        case '7': return colorSeven;
+        case '8': return colorEight;
+        default: return nullptr;
+    }
+}
+
+// background colours would bleed into the padding, so they are closed after every cell
+static bool isBackground(const char* colour)
+{
+    return colour == colorFour || colour == colorFive || colour == colorSix;
+}
+
+static char shownValue(const Cell& cell, bool revealAll)
+{
+    if(revealAll) return cell.getValue();
+    if(cell.getFlag()) return 'F';
+    return cell.getDisplayValue();
+}
+
+static int digits(int value)
+{
+    int count = 1;
+    while(value > 9){
+        value /= 10;
+        count++;
+    }
+    return count;
+}
+
+TerminalRenderer::TerminalRenderer(int fd, int screenRows)
+{
+    m_fd = fd;
+    m_screenRows = screenRows;
+    m_screenCols = INT_MAX;
+    if(screenRows < 0){
+        winsize size;
+        if(isatty(fd) && ioctl(fd, TIOCGWINSZ, &size) == 0){
+            m_screenRows = size.ws_row;
+            m_screenCols = size.ws_col;
+        }
+        else m_screenRows = 0;
+    }
+    m_colour = nullptr;
+    m_rows = 0;
+    m_cols = 0;
+    m_labelWidth = 0;
+    m_cellWidth = 0;
+    m_flagsShown = 0;
+    m_revealShown = false;
+    m_valid = false;
+}
+
+void TerminalRenderer::invalidate()
+{
+    m_valid = false;
+}
+
+void TerminalRenderer::draw(const Board& board, bool revealAll)
+{
+    m_buffer.clear();
+    if(!m_valid || board.getRows() != m_rows || board.getCols() != m_cols){
+        m_rows = board.getRows();
+        m_cols = board.getCols();
+        m_labelWidth = max(5, digits(m_rows - 1) + 3);
+        m_cellWidth = max(3, digits(m_cols - 1) + 1);
+        // the frame plus a few lines of prompts must fit, or the screen scrolls under the addressing
+        bool addressed = m_screenRows > 0 && m_rows + 6 + PROMPT_LINES <= m_screenRows && m_labelWidth + m_cols * m_cellWidth < m_screenCols;
+        fullFrame(board, revealAll, addressed);
+        m_valid = addressed;
+        flush();
+        return;
+    }
+
+    // only cells that changed are rewritten; neighbours in a row are reached by writing the
+    // padding instead of moving the cursor. Revealing the board changes every cell.
+    bool all = revealAll != m_revealShown;
+    int lastRow = -1, lastCol = -1;
+    for(int i = 0; i < m_rows; i++){
+        // rows are apart by the grid's stride, which includes the sentinel ring
+        const unsigned char* row = reinterpret_cast<const unsigned char*>(&board.getCell(i, 0));
+        unsigned char* seen = &m_seen[size_t(i) * m_cols];
+        if(!all && memcmp(row, seen, m_cols) == 0) continue;
+        for(int j = 0; j < m_cols; j++){
+            if(!all && row[j] == seen[j]) continue;
+            seen[j] = row[j];
+            if(i == lastRow && j == lastCol + 1) m_buffer.append(m_cellWidth - 1, ' ');
+            else moveTo(i + 3, m_labelWidth + j * m_cellWidth + 1);
+            appendCell(shownValue(board.getCell(i, j), revealAll));
+            lastRow = i;
+            lastCol = j;
+        }
+    }
+    m_revealShown = revealAll;
+    if(board.getFlagCount() != m_flagsShown){
+        moveTo(m_rows + 4, 1);
+        m_buffer += "\033[2KBombs Flagged: ";
+        appendNumber(board.getFlagCount());
+        m_buffer += " / ";
+        appendNumber(board.getBombs());
+        m_flagsShown = board.getFlagCount();
+    }
+    moveTo(m_rows + 6, 1);
+    m_buffer += "\033[J";
+    flush();
+}
+
+void TerminalRenderer::fullFrame(const Board& board, bool revealAll, bool addressed)
+{
+    if(addressed) m_buffer += "\033[H\033[2J";
+    m_buffer += "-----------------------\n";
+    m_buffer.append(m_labelWidth, ' ');
+    for(int j = 0; j < m_cols; j++){
+        appendPadded(j, m_cellWidth);
+    }
+    m_buffer += '\n';
+    m_seen.resize(size_t(m_rows) * m_cols);
+    for(int i = 0; i < m_rows; i++){
+        memcpy(&m_seen[size_t(i) * m_cols], &board.getCell(i, 0), m_cols);
+    }
+    m_revealShown = revealAll;
+    for(int i = 0; i < m_rows; i++){
+        appendPadded(i, m_labelWidth - 2);
+        m_buffer += "| ";
+        for(int j = 0; j < m_cols; j++){
+            appendCell(shownValue(board.getCell(i, j), revealAll));
+            m_buffer.append(m_cellWidth - 1, ' ');
+        }
+        endColour();
+        m_buffer += '\n';
+    }
+    m_buffer += "\nBombs Flagged: ";
+    appendNumber(board.getFlagCount());
+    m_buffer += " / ";
+    appendNumber(board.getBombs());
+    m_buffer += "\n-----------------------\n";
+    m_flagsShown = board.getFlagCount();
+}
+
+// Cells sharing a foreground colour share one colour sequence; blanks keep whatever is active.
+void TerminalRenderer::appendCell(char value)
+{
+    if(value == ' '){
+        m_buffer += ' ';
+        return;
+    }
+    const char* colour = colourOf(value);
+    if(colour != m_colour){
+        endColour();
+        if(colour) m_buffer += colour;
+        m_colour = colour;
+    }
+    m_buffer += value;
+    if(isBackground(colour)) endColour();
+}
+
+void TerminalRenderer::appendNumber(int value)
+{
+    char text[16];
+    char* end = to_chars(text, text + sizeof(text), value).ptr;
+    m_buffer.append(text, end);
+}
+
+void TerminalRenderer::appendPadded(int value, int width)
+{
+    size_t start = m_buffer.size();
+    appendNumber(value);
+    int written = m_buffer.size() - start;
+    m_buffer.append(written < width ? width - written : 1, ' ');
+}
+
+void TerminalRenderer::moveTo(int line, int column)
+{
+    endColour();
+    m_buffer += "\033[";
+    appendNumber(line);
+    m_buffer += ';';
+    appendNumber(column);
+    m_buffer += 'H';
+}
+
+void TerminalRenderer::endColour()
+{
+    if(m_colour){
+        m_buffer += reset;
+        m_colour = nullptr;
+    }
+}
+
+void TerminalRenderer::flush()
+{
+    endColour();
+    const char* data = m_buffer.data();
+    size_t left = m_buffer.size();
+    while(left > 0){
+        ssize_t written = write(m_fd, data, left);
+        if(written < 0){
+            if(errno == EINTR) continue;
+            return;
+        }
+        data += written;
+        left -= written;
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef TERMINALVIEW_H
+#define TERMINALVIEW_H
+
+#include <string>
+#include <vector>
+#include "board.h"
+
+// Text rendering of a board for the terminal frontend. Each frame is built in a reused buffer,
+// with runs of same-coloured cells sharing one colour sequence, and written with a single
+// write(). The first frame clears the screen and draws the whole board at the top. Later frames
+// move the cursor to the cells whose character changed and rewrite only those, update the flag
+// count, and leave the cursor on a cleared line under the board. Boards that do not fit the
+// screen, or output that is not a terminal, get a full frame every time.
+class TerminalRenderer{
+    public:
+        // `screenRows` is the height to lay the board out in: -1 asks the terminal behind `fd`,
+        // 0 always draws full frames.
+        explicit TerminalRenderer(int fd = 1, int screenRows = -1);
+        // `revealAll` shows every cell's real value, as at the end of a game.
+        void draw(const Board& board, bool revealAll);
+        // The next frame is drawn in full.
+        void invalidate();
+    private:
+        void fullFrame(const Board& board, bool revealAll, bool addressed);
+        void appendCell(char value);
+        void appendNumber(int value);
+        void appendPadded(int value, int width);
+        void moveTo(int line, int column);
+        void endColour();
+        void flush();
+        std::string m_buffer;
+        // raw cell bytes as of the last frame; a row that still matches is skipped with one memcmp
+        std::vector<unsigned char> m_seen;
+        const char* m_colour;
+        int m_fd;
+        int m_screenRows;
+        int m_screenCols;
+        int m_rows;
+        int m_cols;
+        int m_labelWidth;
+        int m_cellWidth;
+        int m_flagsShown;
+        bool m_revealShown;
+        bool m_valid;
+};
+
+#endif
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "../board.h"
+#include "../history.h"
+using namespace std;
+
+// Plays random games with a history attached and checks that every undo and redo brings back
+// the board exactly as it was after that move: every cell, the counters, the state and the
+// state hash. Undoing the first click and clicking elsewhere must give the same board as a
+// fresh game clicked there. Exits non-zero on a mismatch.
+//
+//     g++ -std=c++17 -O2 tests/historyTest.cpp -L. -lminesweeper -o historyTest
+
+struct Position{
+    vector<unsigned char> cells;
+    int bombs, flags, unopenedSafe;
+    GameState state;
+    uint64_t hash;
+    bool minesPlaced;
+
+    bool operator==(const Position& other) const
+    {
+        return cells == other.cells && bombs == other.bombs && flags == other.flags &&
+               unopenedSafe == other.unopenedSafe && state == other.state &&
+               hash == other.hash && minesPlaced == other.minesPlaced;
+    }
+};
+
+static Position position(const Board& board)
+{
+    Position p;
+    for(int r = 0; r < board.getRows(); r++){
+        for(int c = 0; c < board.getCols(); c++){
+            p.cells.push_back(*reinterpret_cast<const unsigned char*>(&board.getCell(r, c)));
+        }
+    }
+    p.bombs = board.getBombs();
+    p.flags = board.getFlagCount();
+    p.unopenedSafe = board.getUnopenedSafe();
+    p.state = board.getState();
+    p.hash = board.getStateHash();
+    p.minesPlaced = board.getMinesPlaced();
+    return p;
+}
+
+static int failures = 0;
+
+static void check(bool ok, uint64_t seed, const string& what)
+{
+    if(ok) return;
+    if(failures++ < 10) cout << "seed " << seed << ": " << what << endl;
+}
+
+// A random first click, then random opens and flags until the game ends or `moves` run out,
+// with a random walk back and forward through the history after each. positions[i] is the board after i moves.
+static void playGame(int rows, int cols, int bombs, uint64_t seed, int moves)
+{
+    Random rng(seed);
+    Board board(rows, cols, bombs);
+    board.setSeed(seed);
+    History history;
+    board.trackHistory(&history);
+    vector<Position> positions(1, position(board));
+
+    int firstRow = rng.below(rows), firstCol = rng.below(cols);
+    board.handleFirstClick(firstRow, firstCol);
+    positions.push_back(position(board));
+    size_t current = 1;
+
+    // move 0 is the first click itself, which wins outright when placeMines had to clamp
+    for(int move = 0; move <= moves; move++){
+        if(move > 0){
+            if(board.getState() != GAME_PLAYING) break;
+            int row = rng.below(rows), col = rng.below(cols);
+            MoveResult result = rng.below(4) == 0 ? board.flagCell(row, col) : board.processMove(row, col);
+            if(result != MOVE_OK && result != MOVE_BOMB && result != MOVE_WON) continue;
+            // a new move drops whatever was undone
+            positions.resize(++current);
+            positions.push_back(position(board));
+        }
+
+        // walk back a few entries and forward again, checking each step
+        int back = rng.below(current + 1);
+        for(int step = 0; step < back; step++){
+            check(board.undo(), seed, "undo refused");
+            current--;
+            check(position(board) == positions[current], seed, "undo to move " + to_string(current) + " differs");
+        }
+        int forward = rng.below(back + 1);
+        for(int step = 0; step < forward; step++){
+            check(board.redo(), seed, "redo refused");
+            current++;
+            check(position(board) == positions[current], seed, "redo to move " + to_string(current) + " differs");
+        }
+        if(current == 0){
+            // back before the first click: a new one must deal what a fresh game would
+            int row = rng.below(rows), col = rng.below(cols);
+            board.handleFirstClick(row, col);
+            Board fresh(rows, cols, bombs);
+            fresh.setSeed(seed);
+            fresh.handleFirstClick(row, col);
+            check(position(board) == position(fresh), seed, "first click after undoing the first click differs from a fresh game");
+            positions.resize(1);
+            positions.push_back(position(board));
+            current = 1;
+        }
+    }
+}
+
+int main(){
+    uint64_t seed = 1;
+    for(int game = 0; game < 300; game++) playGame(16, 30, 99, seed++, 60);
+    for(int game = 0; game < 300; game++) playGame(9, 9, 10, seed++, 40);
+    // more bombs than the first click leaves room for, so placeMines clamps the count
+    for(int game = 0; game < 100; game++) playGame(3, 3, 8, seed++, 10);
+    for(int game = 0; game < 100; game++) playGame(10, 10, 92, seed++, 20);
+    cout << (failures ? "FAILED" : "ok") << endl;
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
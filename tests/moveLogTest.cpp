@@ -0,0 +1,113 @@
+#include <iostream>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../board.h"
+#include "../history.h"
+#include "../movelog.h"
+#include "../terminalBatch.h"
+using namespace std;
+
+// Round trip through the move log: plays a batch of random games with runBatch while recording
+// them, then replays the log on fresh boards and checks the state hash after every move. The
+// batch includes dense boards where undoing the first click and clicking elsewhere deals a
+// different bomb count. Exits non-zero if a game diverges.
+//
+//     g++ -std=c++17 -O2 tests/moveLogTest.cpp terminalBatch.cpp terminalView.cpp -L. -lminesweeper -o moveLogTest
+
+static string randomGames(int games)
+{
+    Random rng(1);
+    // a first click in the middle of a board leaves fewer cells for bombs than a corner one:
+    // none at all on 3x3, 91 for 92 bombs on 10x10 against 96 in the corner
+    string stream = "game 3 3 8 5\no 1 1\nu\no 0 0\n"
+                    "game 10 10 92 251\no 5 5\nu\no 0 0\nu\nr\n";
+    const char actions[] = "oooooofcur";
+    for(int game = 0; game < games; game++){
+        int rows = 3 + rng.below(14), cols = 3 + rng.below(28);
+        int bombs = 1 + rng.below(rows * cols - 1);
+        stream += "game " + to_string(rows) + " " + to_string(cols) + " " + to_string(bombs) + " " + to_string(rng.next() % 1000000) + "\n";
+        int moves = 1 + rng.below(40);
+        for(int move = 0; move < moves; move++){
+            char action = actions[rng.below(sizeof(actions) - 1)];
+            if(action == 'u' || action == 'r') stream += string(1, action) + "\n";
+            else stream += string(1, action) + " " + to_string(rng.below(rows)) + " " + to_string(rng.below(cols)) + "\n";
+        }
+    }
+    return stream;
+}
+
+static bool writeFile(const string& path, const string& data)
+{
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) return false;
+    bool ok = write(fd, data.data(), data.size()) == ssize_t(data.size());
+    return close(fd) == 0 && ok;
+}
+
+int main(){
+    char directory[] = "/tmp/moveLogTestXXXXXX";
+    if(!mkdtemp(directory)) return EXIT_FAILURE;
+    string streamPath = string(directory) + "/games.txt", logPath = string(directory) + "/games.log";
+    if(!writeFile(streamPath, randomGames(300))) return EXIT_FAILURE;
+
+    // play the batch with its result lines sent to /dev/null
+    MoveLogWriter log;
+    int stream = open(streamPath.c_str(), O_RDONLY);
+    int quiet = open("/dev/null", O_WRONLY);
+    int saved = dup(1);
+    if(!log.open(logPath) || stream < 0 || quiet < 0 || saved < 0) return EXIT_FAILURE;
+    dup2(quiet, 1);
+    bool played = runBatch(stream, 0, false, log);
+    dup2(saved, 1);
+    close(saved);
+    close(quiet);
+    close(stream);
+    if(!played || !log.close()){
+        cout << "the batch failed: " << log.getError() << endl;
+        return EXIT_FAILURE;
+    }
+
+    MoveLogReader reader;
+    if(!reader.open(logPath)){
+        cout << reader.getError() << endl;
+        return EXIT_FAILURE;
+    }
+    GameEntry game;
+    MoveEntry move;
+    MoveAction kind;
+    Board* board = nullptr;
+    History history;
+    int games = 0, moves = 0, failures = 0;
+    bool diverged = false;
+    while(reader.next(game, move, kind)){
+        if(kind == ACTION_GAME){
+            delete board;
+            board = new Board(game.rows, game.cols, game.bombs);
+            board->setSeed(game.seed);
+            board->trackHistory(&history);
+            games++;
+            moves = 0;
+            diverged = false;
+            continue;
+        }
+        moves++;
+        if(diverged || replayMove(*board, move)) continue;
+        cout << "game " << games << " (" << game.rows << "x" << game.cols << ", " << game.bombs << " bombs) diverges at move " << moves << endl;
+        diverged = true;
+        failures++;
+    }
+    delete board;
+    unlink(streamPath.c_str());
+    unlink(logPath.c_str());
+    rmdir(directory);
+    if(!reader.getError().empty()){
+        cout << reader.getError() << endl;
+        return EXIT_FAILURE;
+    }
+    if(games < 250) failures++;
+    cout << (failures ? "FAILED" : "ok") << endl;
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "../board.h"
+#include "../probability.h"
+using namespace std;
+
+// Checks ProbabilityEngine against brute force: plays small boards to random positions, then
+// enumerates every way to put the remaining bombs on the closed, unflagged cells, keeps the
+// layouts every visible number agrees with, and compares each cell's share of them with the
+// engine's probability. Exits non-zero on a difference past 1e-9.
+//
+//     g++ -std=c++17 -O2 tests/probabilityTest.cpp -L. -lminesweeper -o probabilityTest
+
+// the brute force enumerates subsets of at most this many cells
+const int MAX_CLOSED = 20;
+
+// A random first click, then random safe opens and correct flags until few enough cells are
+// left closed. False if the game ended first.
+static bool playToPosition(Board& board, Random& rng)
+{
+    int rows = board.getRows(), cols = board.getCols();
+    board.handleFirstClick(rng.below(rows), rng.below(cols));
+    while(board.stillPlaying()){
+        vector<int> closed;
+        for(int i = 0; i < rows * cols; i++){
+            const Cell& cell = board.getCell(i / cols, i % cols);
+            if(!cell.isOpened() && !cell.getFlag()) closed.push_back(i);
+        }
+        if(int(closed.size()) <= MAX_CLOSED && rng.below(3) == 0) return true;
+        int pick = closed[rng.below(closed.size())];
+        if(board.getCell(pick / cols, pick % cols).isBomb()) board.flagCell(pick / cols, pick % cols);
+        else board.processMove(pick / cols, pick % cols);
+    }
+    return false;
+}
+
+// Each cell's share of the layouts that fit, or an empty vector when none does.
+static vector<double> bruteForce(const Board& board)
+{
+    int rows = board.getRows(), cols = board.getCols();
+    vector<int> closed;
+    vector<int> bit(rows * cols, -1);
+    for(int i = 0; i < rows * cols; i++){
+        const Cell& cell = board.getCell(i / cols, i % cols);
+        if(!cell.isOpened() && !cell.getFlag()){
+            bit[i] = closed.size();
+            closed.push_back(i);
+        }
+    }
+    // every open number as a mask of the closed cells around it and the bombs it still needs
+    vector<pair<uint32_t, int>> numbers;
+    for(int r = 0; r < rows; r++){
+        for(int c = 0; c < cols; c++){
+            const Cell& cell = board.getCell(r, c);
+            if(!cell.isOpened()) continue;
+            uint32_t mask = 0;
+            int need = cell.getCount();
+            for(int nr = r - 1; nr <= r + 1; nr++){
+                for(int nc = c - 1; nc <= c + 1; nc++){
+                    if(nr < 0 || nc < 0 || nr >= rows || nc >= cols || (nr == r && nc == c)) continue;
+                    if(board.getCell(nr, nc).getFlag()) need--;
+                    else if(bit[nr * cols + nc] >= 0) mask |= 1u << bit[nr * cols + nc];
+                }
+            }
+            if(mask || need) numbers.push_back(make_pair(mask, need));
+        }
+    }
+    int remaining = board.getBombs() - board.getFlagCount();
+    vector<double> bombs(closed.size(), 0);
+    double layouts = 0;
+    for(uint32_t layout = 0; layout < (1u << closed.size()); layout++){
+        if(__builtin_popcount(layout) != remaining) continue;
+        bool fits = true;
+        for(size_t i = 0; i < numbers.size() && fits; i++){
+            fits = __builtin_popcount(layout & numbers[i].first) == numbers[i].second;
+        }
+        if(!fits) continue;
+        layouts++;
+        for(size_t i = 0; i < closed.size(); i++){
+            if(layout >> i & 1) bombs[i]++;
+        }
+    }
+    if(layouts == 0) return vector<double>();
+    vector<double> probabilities(rows * cols, 0);
+    for(int i = 0; i < rows * cols; i++){
+        if(board.getCell(i / cols, i % cols).getFlag()) probabilities[i] = 1;
+        else if(bit[i] >= 0) probabilities[i] = bombs[bit[i]] / layouts;
+    }
+    return probabilities;
+}
+
+int main(){
+    const int sizes[][3] = {{4, 4, 3}, {5, 5, 5}, {5, 6, 8}, {6, 6, 7}, {4, 8, 9}, {6, 7, 12}};
+    Random rng(9);
+    ProbabilityEngine engine;
+    vector<double> probabilities;
+    int positions = 0, failures = 0;
+    double worst = 0;
+    for(uint64_t seed = 1; positions < 300; seed++){
+        const int* size = sizes[seed % 6];
+        Board board(size[0], size[1], size[2]);
+        board.setSeed(seed);
+        if(!playToPosition(board, rng)) continue;
+        positions++;
+        vector<double> expected = bruteForce(board);
+        if(expected.empty() || !engine.compute(board, probabilities)){
+            cout << "seed " << seed << ": no layout fits the position" << endl;
+            failures++;
+            continue;
+        }
+        double error = 0;
+        for(size_t i = 0; i < expected.size(); i++){
+            error = max(error, fabs(expected[i] - probabilities[i]));
+        }
+        worst = max(worst, error);
+        if(error > 1e-9){
+            cout << "seed " << seed << ": off by " << error << endl;
+            failures++;
+        }
+    }
+    cout << positions << " positions, largest error " << worst << endl;
+    cout << (failures ? "FAILED" : "ok") << endl;
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,214 @@
+#include <iostream>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../board.h"
+#include "../history.h"
+#include "../terminalView.h"
+using namespace std;
+
+// Checks the terminal renderer's diff frames against full redraws on an emulated screen. Plays
+// random games, including flags, chords, undo, redo and the final reveal. After every move it
+// feeds the diff frame to one screen and a full frame from a fresh renderer to another. The two
+// screens must then show the same characters in the same colours. Exits non-zero on a mismatch.
+//
+//     g++ -std=c++17 -O2 tests/terminalScreenTest.cpp terminalView.cpp -L. -lminesweeper -o terminalScreenTest
+
+const int SCREEN_LINES = 200;
+const int SCREEN_COLUMNS = 500;
+
+// Just enough of a VT100 for the renderer: printing, newlines, cursor addressing, erasing the
+// line or the screen, and SGR colours. A newline also returns the cursor, as a tty does.
+class Screen{
+    public:
+        Screen();
+        void feed(const string& bytes);
+        // the first line and column that differ, as "line:column", or "" when none does
+        string differs(const Screen& other) const;
+        // whether anything was printed past the bottom or the right edge
+        bool overflowed() const;
+    private:
+        struct Glyph{
+            char ch;
+            int foreground;
+            int background;
+        };
+        void put(char ch);
+        void erase(int from, int to);
+        void control(const string& parameters, char command);
+        vector<Glyph> m_glyphs;
+        int m_line;
+        int m_column;
+        int m_foreground;
+        int m_background;
+        bool m_overflowed;
+};
+
+Screen::Screen() : m_glyphs(SCREEN_LINES * SCREEN_COLUMNS, Glyph{' ', 0, 0})
+{
+    m_line = 0;
+    m_column = 0;
+    m_foreground = 0;
+    m_background = 0;
+    m_overflowed = false;
+}
+
+void Screen::feed(const string& bytes)
+{
+    for(size_t i = 0; i < bytes.size(); i++){
+        char ch = bytes[i];
+        if(ch == '\033' && i + 1 < bytes.size() && bytes[i + 1] == '['){
+            size_t end = bytes.find_first_not_of("0123456789;", i + 2);
+            if(end == string::npos) return;
+            control(bytes.substr(i + 2, end - i - 2), bytes[end]);
+            i = end;
+        }
+        else if(ch == '\n'){
+            m_line++;
+            m_column = 0;
+        }
+        else if(ch == '\r') m_column = 0;
+        else put(ch);
+    }
+}
+
+void Screen::put(char ch)
+{
+    if(m_line >= SCREEN_LINES || m_column >= SCREEN_COLUMNS){
+        m_overflowed = true;
+        return;
+    }
+    m_glyphs[m_line * SCREEN_COLUMNS + m_column] = Glyph{ch, m_foreground, m_background};
+    m_column++;
+}
+
+void Screen::erase(int from, int to)
+{
+    for(int i = max(from, 0); i < min(to, SCREEN_LINES * SCREEN_COLUMNS); i++){
+        m_glyphs[i] = Glyph{' ', 0, 0};
+    }
+}
+
+void Screen::control(const string& parameters, char command)
+{
+    vector<int> values;
+    size_t start = 0;
+    while(start <= parameters.size()){
+        size_t end = parameters.find(';', start);
+        if(end == string::npos) end = parameters.size();
+        values.push_back(end > start ? atoi(parameters.c_str() + start) : 0);
+        start = end + 1;
+    }
+    int here = m_line * SCREEN_COLUMNS + m_column;
+    if(command == 'H'){
+        m_line = (values[0] ? values[0] : 1) - 1;
+        m_column = (values.size() > 1 && values[1] ? values[1] : 1) - 1;
+    }
+    else if(command == 'J') erase(values[0] == 2 ? 0 : here, SCREEN_LINES * SCREEN_COLUMNS);
+    else if(command == 'K') erase(values[0] == 2 ? m_line * SCREEN_COLUMNS : here, (m_line + 1) * SCREEN_COLUMNS);
+    else if(command == 'm'){
+        for(int value : values){
+            if(value == 0) m_foreground = m_background = 0;
+            else if((value >= 30 && value <= 37) || (value >= 90 && value <= 97)) m_foreground = value;
+            else if((value >= 40 && value <= 47) || (value >= 100 && value <= 107)) m_background = value;
+        }
+    }
+}
+
+string Screen::differs(const Screen& other) const
+{
+    for(int i = 0; i < SCREEN_LINES * SCREEN_COLUMNS; i++){
+        const Glyph& a = m_glyphs[i];
+        const Glyph& b = other.m_glyphs[i];
+        // a blank shows no foreground colour
+        bool same = a.ch == b.ch && a.background == b.background && (a.ch == ' ' || a.foreground == b.foreground);
+        if(!same) return to_string(i / SCREEN_COLUMNS + 1) + ":" + to_string(i % SCREEN_COLUMNS + 1);
+    }
+    return "";
+}
+
+bool Screen::overflowed() const
+{
+    return m_overflowed;
+}
+
+static string drain(int fd)
+{
+    string out;
+    char chunk[1 << 16];
+    ssize_t got;
+    while((got = read(fd, chunk, sizeof(chunk))) > 0) out.append(chunk, got);
+    return out;
+}
+
+// Draws `board` with `renderer` into `screen`, through a pipe the size of a large frame.
+static bool drawInto(TerminalRenderer& renderer, int pipes[2], Screen& screen, const Board& board, bool revealAll)
+{
+    renderer.draw(board, revealAll);
+    screen.feed(drain(pipes[0]));
+    return !screen.overflowed();
+}
+
+static int failures = 0;
+
+static void playGame(int rows, int cols, int bombs, uint64_t seed, int moves)
+{
+    int diffPipe[2], fullPipe[2];
+    if(pipe(diffPipe) != 0 || pipe(fullPipe) != 0) exit(EXIT_FAILURE);
+    fcntl(diffPipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(fullPipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(diffPipe[1], F_SETPIPE_SZ, 1 << 20);
+    fcntl(fullPipe[1], F_SETPIPE_SZ, 1 << 20);
+
+    Random rng(seed);
+    Board board(rows, cols, bombs);
+    board.setSeed(seed);
+    History history;
+    board.trackHistory(&history);
+    TerminalRenderer diff(diffPipe[1], SCREEN_LINES);
+    Screen diffScreen;
+    drawInto(diff, diffPipe, diffScreen, board, false);
+    board.handleFirstClick(rng.below(rows), rng.below(cols));
+
+    for(int move = 0; move <= moves; move++){
+        if(move > 0 && board.stillPlaying()){
+            int row = rng.below(rows), col = rng.below(cols);
+            int kind = rng.below(10);
+            if(kind < 5) board.processMove(row, col);
+            else if(kind < 7) board.flagCell(row, col);
+            else if(kind < 8) board.chordCell(row, col);
+            else if(kind < 9) board.undo();
+            else board.redo();
+        }
+        bool revealAll = !board.stillPlaying();
+        TerminalRenderer full(fullPipe[1], SCREEN_LINES);
+        Screen fullScreen;
+        bool fits = drawInto(diff, diffPipe, diffScreen, board, revealAll) && drawInto(full, fullPipe, fullScreen, board, revealAll);
+        string where = fullScreen.differs(diffScreen);
+        if(!fits || !where.empty()){
+            if(failures++ < 10){
+                cout << rows << "x" << cols << " seed " << seed << ", move " << move << ": ";
+                cout << (fits ? "the diff frame leaves " + where + " unlike a full redraw" : "the frame runs off the screen") << endl;
+            }
+            break;
+        }
+        if(revealAll) break;
+    }
+    close(diffPipe[0]);
+    close(diffPipe[1]);
+    close(fullPipe[0]);
+    close(fullPipe[1]);
+}
+
+int main(){
+    // the last two need wider cells and labels: 3-digit columns and rows
+    const int sizes[][3] = {{9, 9, 10}, {16, 30, 99}, {24, 24, 99}, {12, 110, 150}, {120, 12, 150}};
+    uint64_t seed = 1;
+    for(const int* size : sizes){
+        for(int game = 0; game < 40; game++) playGame(size[0], size[1], size[2], seed++, 80);
+    }
+    cout << (failures ? "FAILED" : "ok") << endl;
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
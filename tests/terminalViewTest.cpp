@@ -0,0 +1,84 @@
+#include <iostream>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../board.h"
+#include "../terminalView.h"
+using namespace std;
+
+// Checks that a diff frame repaints exactly the cell a move changed: opens one numbered cell
+// low on the board after the first click, draws, and looks at every cursor move in the frame.
+// Exits non-zero on a mismatch.
+//
+//     g++ -std=c++17 -O2 tests/terminalViewTest.cpp terminalView.cpp -L. -lminesweeper -o terminalViewTest
+
+static string drain(int fd)
+{
+    string out;
+    char chunk[4096];
+    ssize_t got;
+    while((got = read(fd, chunk, sizeof(chunk))) > 0) out.append(chunk, got);
+    return out;
+}
+
+// every "\033[line;columnH" in the frame
+static vector<pair<int, int>> cursorMoves(const string& frame)
+{
+    vector<pair<int, int>> moves;
+    size_t at = 0;
+    while((at = frame.find("\033[", at)) != string::npos){
+        at += 2;
+        size_t end = frame.find_first_not_of("0123456789;", at);
+        if(end == string::npos || frame[end] != 'H' || frame.find(';', at) > end) continue;
+        size_t semicolon = frame.find(';', at);
+        moves.push_back(make_pair(atoi(frame.c_str() + at), atoi(frame.c_str() + semicolon + 1)));
+    }
+    return moves;
+}
+
+int main(){
+    const int rows = 16, cols = 30;
+    int failures = 0;
+    for(uint64_t seed = 1; seed <= 50; seed++){
+        Board board(rows, cols, 99);
+        board.setSeed(seed);
+        board.handleFirstClick(8, 15);
+        int row = -1, col = -1;
+        for(int r = rows - 1; r >= 0 && row < 0; r--){
+            for(int c = 0; c < cols; c++){
+                const Cell& cell = board.getCell(r, c);
+                if(!cell.isOpened() && !cell.isBomb() && cell.getCount() > 0){
+                    row = r;
+                    col = c;
+                    break;
+                }
+            }
+        }
+        if(row < 0) continue;
+
+        int pipes[2];
+        if(pipe(pipes) != 0) return EXIT_FAILURE;
+        fcntl(pipes[0], F_SETFL, O_NONBLOCK);
+        TerminalRenderer renderer(pipes[1], 100);
+        renderer.draw(board, false);
+        drain(pipes[0]);
+        board.processMove(row, col);
+        renderer.draw(board, false);
+        string frame = drain(pipes[0]);
+        close(pipes[0]);
+        close(pipes[1]);
+
+        // the 16x30 layout: labels take 5 columns, cells 3, and the board starts on line 3;
+        // the last move parks the cursor under the board
+        vector<pair<int, int>> expected = {make_pair(row + 3, 5 + col * 3 + 1), make_pair(rows + 6, 1)};
+        string value(1, board.getCell(row, col).getDisplayValue());
+        if(cursorMoves(frame) != expected || frame.find(value) == string::npos){
+            cout << "seed " << seed << ": opening (" << row << "," << col << ") repainted the wrong cells" << endl;
+            failures++;
+        }
+    }
+    cout << (failures ? "FAILED" : "ok") << endl;
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}